@@ -3,6 +3,7 @@ $(document).ready( function() {
 	var editor_color = null;
 	var editor_smoothing = null;
 	var editor_blackborder = null;
+	var editor_compositor = null;
 	
 	if(showOptHelp)
 	{
@@ -20,6 +21,11 @@ $(document).ready( function() {
 		$('#conf_cont').append(createRow('conf_cont_blackborder'))
 		$('#conf_cont_blackborder').append(createOptPanel('fa-photo', $.i18n("edt_conf_bb_heading_title"), 'editor_container_blackborder', 'btn_submit_blackborder'));
 		$('#conf_cont_blackborder').append(createHelpTable(schema.blackborderdetector.properties, $.i18n("edt_conf_bb_heading_title")));
+
+		//compositor
+		$('#conf_cont').append(createRow('conf_cont_compositor'))
+		$('#conf_cont_compositor').append(createOptPanel('fa-photo', $.i18n("edt_conf_compositor_heading_title"), 'editor_container_compositor', 'btn_submit_compositor'));
+		$('#conf_cont_compositor').append(createHelpTable(schema.compositor.properties, $.i18n("edt_conf_compositor_heading_title")));
 	}
 	else
 	{
@@ -27,6 +33,7 @@ $(document).ready( function() {
 		$('#conf_cont').append(createOptPanel('fa-photo', $.i18n("edt_conf_color_heading_title"), 'editor_container_color', 'btn_submit_color'));
 		$('#conf_cont').append(createOptPanel('fa-photo', $.i18n("edt_conf_smooth_heading_title"), 'editor_container_smoothing', 'btn_submit_smoothing'));
 		$('#conf_cont').append(createOptPanel('fa-photo', $.i18n("edt_conf_bb_heading_title"), 'editor_container_blackborder', 'btn_submit_blackborder'));
+		$('#conf_cont').append(createOptPanel('fa-photo', $.i18n("edt_conf_compositor_heading_title"), 'editor_container_compositor', 'btn_submit_compositor'));
 	}
 	
 	//color
@@ -68,6 +75,19 @@ $(document).ready( function() {
 		requestWriteConfig(editor_blackborder.getValue());
 	});
 	
+	//compositor
+	editor_compositor = createJsonEditor('editor_container_compositor', {
+		compositor         : schema.compositor
+	}, true, true);
+
+	editor_compositor.on('change',function() {
+		editor_compositor.validate().length ? $('#btn_submit_compositor').attr('disabled', true) : $('#btn_submit_compositor').attr('disabled', false);
+	});
+
+	$('#btn_submit_compositor').off().on('click',function() {
+		requestWriteConfig(editor_compositor.getValue());
+	});
+
 	//wiki links
 	$('#editor_container_blackborder').append(buildWL("user/moretopics/bbmode","edt_conf_bb_mode_title",true));
 	
@@ -77,6 +97,7 @@ $(document).ready( function() {
 		createHint("intro", $.i18n('conf_colors_color_intro'), "editor_container_color");
 		createHint("intro", $.i18n('conf_colors_smoothing_intro'), "editor_container_smoothing");
 		createHint("intro", $.i18n('conf_colors_blackborder_intro'), "editor_container_blackborder");
+		createHint("intro", $.i18n('conf_colors_compositor_intro'), "editor_container_compositor");
 	}
 	
 	removeOverlay();
@@ -0,0 +1,36 @@
+import hyperion, time
+
+# Benchmark of the image output path: draws the canvas and shows it as fast as possible
+# and prints the achieved frame rate. Use the canvas size to simulate high resolution effects.
+
+# Get the parameters
+width          = int(hyperion.args.get('canvas-width', 1920))
+height         = int(hyperion.args.get('canvas-height', 1080))
+reportInterval = float(hyperion.args.get('report-interval', 5.0))
+
+# enlarge the canvas, the size is kept if the led layout needs a larger one
+width, height = hyperion.imageMinSize(width, height)
+
+# a gradient which changes every frame, so each frame has to be converted
+gradient = bytearray([0,255,0,0,255, 127,0,255,0,255, 255,0,0,255,255])
+
+frames = 0
+angle = 0
+start = time.time()
+print("Image benchmark with a %dx%d canvas" % (width, height))
+
+# effect loop
+while not hyperion.abort():
+	angle = (angle + 1) % 360
+	hyperion.imageConicalGradient(int(width/2), int(height/2), angle, gradient)
+	hyperion.imageShow()
+	frames += 1
+
+	elapsed = time.time() - start
+	if elapsed >= reportInterval:
+		print("Image benchmark: %.1f fps, %.2f ms per frame" % (frames / elapsed, 1000.0 * elapsed / frames))
+		frames = 0
+		start = time.time()
+
+	# yield to other threads
+	time.sleep(0)
@@ -193,6 +193,13 @@ private:
 	///
 	void handleSysInfoCommand(const QJsonObject & message, const QString &command, const int tan);
 
+	///
+	/// Handle an incoming JSON Metrics message, replies the latency histograms of the pipeline stages
+	///
+	/// @param message the incoming message
+	///
+	void handleMetricsCommand(const QJsonObject & message, const QString &command, const int tan);
+
 	///
 	/// Handle an incoming JSON Server info message
 	///
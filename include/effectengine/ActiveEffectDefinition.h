@@ -11,4 +11,8 @@ struct ActiveEffectDefinition
 	int priority;
 	int timeout;
 	QJsonObject args;
+	/// outputs produced by the effect
+	quint64 framesProduced = 0;
+	/// outputs forwarded to Hyperion, the rest has been replaced by newer ones
+	quint64 framesConsumed = 0;
 };
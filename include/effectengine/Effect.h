@@ -13,6 +13,7 @@
 #include <QImage>
 #include <QPainter>
 #include <QMap>
+#include <QMutex>
 
 // Hyperion includes
 #include <utils/Components.h>
@@ -54,16 +55,105 @@ public:
 
 	QJsonObject getArgs() const { return _args; }
 
+	///
+	/// @brief Forward the latest output of the effect to Hyperion, called from the main thread.
+	///        Outputs which have been replaced before they got forwarded are dropped
+	///
+	void forwardOutput();
+
+	///
+	/// @brief Get the number of outputs produced by the effect and forwarded to Hyperion
+	/// @param[out] produced  Outputs produced by the effect
+	/// @param[out] consumed  Outputs forwarded to Hyperion
+	///
+	void getFrameCounters(quint64& produced, quint64& consumed);
+
+protected:
+	///
+	/// @brief Construct an effect without Hyperion for headless runs, e.g. the effect-bench.
+	///        Outputs are passed to writeOutput()/writeOutputImage(), which have to be implemented
+	/// @param ledCount     The number of leds
+	/// @param latchTime    The latch time of the led device in ms
+	/// @param ledGridSize  The size of the led layout, the initial canvas size
+	///
+	Effect(int ledCount, int latchTime, const QSize & ledGridSize, int priority, int timeout, const QString & script, const QString & name, const QJsonObject & args = QJsonObject());
+
+	///
+	/// @brief The clock of the effect, used for timeouts and, if _simulatedClock is set, for time.time() of python effects
+	/// @return The time in ms since epoch
+	///
+	virtual qint64 currentTime();
+
+	///
+	/// @brief Wait until the next frame of a native effect is due. If _simulatedClock is set, python effects call it from time.sleep()
+	/// @param ms  The time in ms
+	///
+	virtual void waitFor(int ms);
+
+	///
+	/// @brief Write forwarded led colors, sets the input of Hyperion
+	/// @param ledColors  The led colors
+	/// @param timeout_ms The timeout of the output
+	///
+	virtual void writeOutput(const std::vector<ColorRgb>& ledColors, const int timeout_ms);
+
+	///
+	/// @brief Write a forwarded image, sets the input image of Hyperion
+	/// @param image      The image
+	/// @param timeout_ms The timeout of the output
+	///
+	virtual void writeOutputImage(const Image<ColorRgb>& image, const int timeout_ms);
+
+	/// Python effects use currentTime() and waitFor() instead of the time module and get a fixed random seed
+	bool _simulatedClock;
+
 signals:
-	void setInput(const int priority, const std::vector<ColorRgb>& ledColors, const int timeout_ms, const bool& clearEffect);
-	void setInputImage(const int priority, const Image<ColorRgb>& image, const int timeout_ms, const bool& clearEffect);
+	///
+	/// @brief Emits when a new output is available and the previous one has been forwarded,
+	///        so there is at most one notification per effect in the event queue
+	///
+	void outputAvailable();
 
 private:
+	///
+	/// @brief Run a native effect instead of the python script
+	///
+	void runNative();
+
+	///
+	/// @brief Replace the pending output with led colors, called from the effect thread
+	/// @param ledColors  The led colors
+	/// @param timeout_ms The timeout of the output
+	///
+	void setOutput(const QVector<ColorRgb>& ledColors, const int timeout_ms);
+
+	///
+	/// @brief Replace the pending output with an image, called from the effect thread
+	/// @param image      The image
+	/// @param timeout_ms The timeout of the output
+	///
+	void setOutputImage(const Image<ColorRgb>& image, const int timeout_ms);
+
+	///
+	/// @brief Replace the pending output with a 32 bit QImage, converted directly into the output buffer
+	/// @param qimage     The image
+	/// @param timeout_ms The timeout of the output
+	///
+	void setOutputImage(const QImage& qimage, const int timeout_ms);
+
+	///
+	/// @brief Mark a new output as produced, the output mutex has to be locked
+	///
+	void outputProduced();
+
 
 	void addImage();
 
 	Hyperion* _hyperion;
 
+	/// Latch time of the led device in ms
+	const int _latchTime;
+
 	const int _priority;
 
 	const int _timeout;
@@ -86,4 +176,24 @@ private:
 	QImage          _image;
 	QPainter*       _painter;
 	QVector<QImage> _imageStack;
+
+	/// Guards the pending output and the frame counters
+	QMutex _outputMutex;
+
+	/// The pending output, written by the effect thread
+	bool _outputPending;
+	bool _outputIsImage;
+	int _outputTimeout;
+	std::vector<ColorRgb> _outputColors;
+	Image<ColorRgb> _outputImage;
+
+	/// The output which is forwarded to Hyperion, swapped with the pending output
+	std::vector<ColorRgb> _forwardColors;
+	Image<ColorRgb> _forwardImage;
+
+	quint64 _framesProduced;
+	quint64 _framesConsumed;
+
+	/// CPU time of the effect thread which has been accounted to the metrics
+	int64_t _cpuTime;
 };
@@ -52,6 +52,16 @@ public:
 	///
 	void startCachedEffects();
 
+	///
+	/// @brief Read and validate an effect definition, the smoothing config is not registered at Hyperion
+	/// @param path              The effect directory
+	/// @param effectConfigFile  The file name of the definition
+	/// @param[out] effectDefinition  The definition
+	/// @param log               The logger for errors
+	/// @return True on success
+	///
+	static bool readEffectDefinition(const QString & path, const QString & effectConfigFile, EffectDefinition & effectDefinition, Logger * log);
+
 signals:
 	/// Emit when the effect list has been updated
 	void effectListUpdated();
@@ -69,9 +79,19 @@ public slots:
 	/// Clear all effects
 	void allChannelsCleared();
 
+	///
+	/// @brief Handle settings update from Hyperion Settingsmanager emit
+	/// @param type   settingyType from enum
+	/// @param config configuration object
+	///
+	void handleSettingsUpdate(const settings::type& type, const QJsonDocument& config);
+
 private slots:
 	void effectFinished();
 
+	/// Forward the latest output of the sending effect to Hyperion
+	void effectOutputAvailable();
+
 private:
 	bool loadEffectDefinition(const QString & path, const QString & effectConfigFile, EffectDefinition &effectDefinition);
 
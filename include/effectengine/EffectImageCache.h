@@ -0,0 +1,75 @@
+#pragma once
+
+// Qt includes
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QDateTime>
+#include <QCache>
+#include <QMutex>
+
+/// Default memory budget of the cache in KiB
+#define EFFECT_IMAGE_CACHE_SIZE 65536
+
+///
+/// A decoded image frame, the data is packed rgb and shared read-only
+///
+struct EffectImageFrame
+{
+	int width;
+	int height;
+	QByteArray data;
+};
+
+typedef QVector<EffectImageFrame> EffectImageFrames;
+
+///
+/// Process-wide cache of decoded effect images (all frames of animated images), keyed by file path
+/// and modification time. Least recently used images are evicted once the memory budget is exceeded.
+/// Frames are implicitly shared, so effect threads get them without copying.
+///
+class EffectImageCache
+{
+public:
+	static EffectImageCache* getInstance();
+
+	///
+	/// @brief Get the decoded frames of an image, decodes the image on a cache miss or if the file changed
+	/// @param[in]  file    The image file, resources start with ':'
+	/// @param[out] frames  The decoded frames
+	/// @param[out] error   The error message if the image could not be read
+	/// @return True on success
+	///
+	bool getFrames(const QString& file, EffectImageFrames& frames, QString& error);
+
+	///
+	/// @brief Set the memory budget, shrinks the cache immediately
+	/// @param kibibytes  The budget in KiB
+	///
+	void setMaxSize(int kibibytes);
+
+	///
+	/// @brief Remove all cached images
+	///
+	void clear();
+
+private:
+	EffectImageCache();
+
+	///
+	/// @brief Decode all frames of an image
+	///
+	static bool decode(const QString& file, EffectImageFrames& frames, QString& error);
+
+	struct Entry
+	{
+		QDateTime lastModified;
+		EffectImageFrames frames;
+	};
+
+	/// QCache is not thread safe
+	QMutex _mutex;
+
+	/// cost of an entry is its size in KiB
+	QCache<QString, Entry> _cache;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+// Python includes
+// collide of qt slots macro
+#undef slots
+#include "Python.h"
+#define slots
+
+// Qt includes
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+/// Number of warm interpreters kept for effect starts
+#define EFFECT_INTERPRETER_POOL_SIZE 2
+
+///
+/// Keeps python sub-interpreters with the common effect modules already imported, so an effect start
+/// only binds its thread to an interpreter instead of creating one. Also caches the compiled code of the
+/// effect scripts, keyed by path and modification time, as marshalled bytecode which every interpreter
+/// can load without parsing and compiling the script again.
+///
+class EffectInterpreterPool
+{
+public:
+	static EffectInterpreterPool* getInstance();
+
+	///
+	/// @brief Create interpreters until the pool is full, called from the main thread without holding the GIL
+	///
+	void warmUp();
+
+	///
+	/// @brief Get a thread state of a warm interpreter for the current thread, or of a new interpreter if
+	///        the pool is empty. The GIL has to be held, the returned thread state is the current one.
+	/// @return The thread state or nullptr on failure
+	///
+	PyThreadState* acquire();
+
+	///
+	/// @brief Return the interpreter of a thread state from acquire(). Resets the __main__ module and puts the
+	///        interpreter back into the pool, or ends it if the pool is full or the interpreter is not reusable.
+	///        The GIL has to be held and tstate has to be the current thread state, no thread state is current afterwards.
+	/// @param tstate    The thread state
+	/// @param reusable  False if the script left the interpreter in an unknown state, e.g. by an exception
+	///
+	void release(PyThreadState* tstate, bool reusable);
+
+	///
+	/// @brief Get the compiled code of a script, compiles the script on a cache miss or if the file changed.
+	///        The GIL has to be held
+	/// @param[in]  script  The script file
+	/// @param[out] error   The error message if the file could not be read
+	/// @return New reference to the code object, nullptr with error or the python exception set on failure
+	///
+	PyObject* getCode(const QString& script, QString& error);
+
+	///
+	/// @brief End all pooled interpreters, called before python is finalized with the GIL held by the main thread
+	///
+	void clear();
+
+private:
+	EffectInterpreterPool();
+
+	///
+	/// @brief Create an interpreter, the new thread state is the current one
+	/// @return The thread state or nullptr on failure
+	///
+	PyThreadState* createInterpreter();
+
+	struct Interpreter
+	{
+		PyInterpreterState* state;
+		/// content of the __main__ module after the interpreter has been created
+		PyObject* mainDict;
+	};
+
+	struct Code
+	{
+		QDateTime lastModified;
+		QByteArray bytecode;
+	};
+
+	/// guards the containers, never held while python code runs
+	QMutex _mutex;
+
+	/// Interpreters ready to be acquired
+	QList<Interpreter> _pool;
+
+	/// Pristine __main__ content of acquired interpreters
+	QHash<PyInterpreterState*, PyObject*> _mainDicts;
+
+	/// Marshalled bytecode per script
+	QHash<QString, Code> _code;
+};
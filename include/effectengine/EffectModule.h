@@ -5,6 +5,9 @@
 #define slots
 
 #include <QJsonValue>
+#include <QImage>
+
+#include <utils/ColorRgb.h>
 
 class Effect;
 
@@ -23,6 +26,15 @@ public:
 	// json 2 python
 	static PyObject * json2python(const QJsonValue & jsonData);
 
+	// convert a 32 bit QImage in a single pass to packed rgb, rgb must hold 3*width*height bytes
+	static void qimage2rgb(const QImage & qimage, uint8_t * rgb);
+
+	// replace the clock of the time module with the clock of the effect and seed random, for effects with a simulated clock
+	static void simulateClock();
+
+	// clip a led range given as start and count (negative: up to the last led) to a buffer of size leds
+	static void ledRange(int size, int start, int count, int & begin, int & end);
+
 	// Wrapper methods for Python interpreter extra buildin methods
 	static PyMethodDef effectMethods[];
 	static PyObject* wrapSetColor              (PyObject *self, PyObject *args);
@@ -49,5 +61,18 @@ public:
 	static PyObject* wrapImageCOffset          (PyObject *self, PyObject *args);
 	static PyObject* wrapImageCShear           (PyObject *self, PyObject *args);
 	static PyObject* wrapImageResetT           (PyObject *self, PyObject *args);
+	static PyObject* wrapLedFill               (PyObject *self, PyObject *args);
+	static PyObject* wrapLedHsvGradient        (PyObject *self, PyObject *args);
+	static PyObject* wrapLedFade               (PyObject *self, PyObject *args);
+	static PyObject* wrapLedRotate             (PyObject *self, PyObject *args);
+	static PyObject* wrapLedShift              (PyObject *self, PyObject *args);
+	static PyObject* wrapLedBlend              (PyObject *self, PyObject *args);
+	static PyObject* wrapLedGet                (PyObject *self, PyObject *args);
+	static PyObject* wrapLedShow               (PyObject *self, PyObject *args);
+
+	// Wrapper methods for the time module of effects with a simulated clock
+	static PyMethodDef clockMethods[];
+	static PyObject* wrapClockTime             (PyObject *self, PyObject *args);
+	static PyObject* wrapClockSleep            (PyObject *self, PyObject *args);
 	static Effect  * getEffect();
 };
@@ -0,0 +1,110 @@
+#pragma once
+
+// Qt includes
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QVector>
+#include <QImage>
+#include <QSize>
+
+// Hyperion includes
+#include <utils/ColorRgb.h>
+
+/// Script prefix of native effects in effect definitions, e.g. "native:knight-rider"
+#define NATIVE_EFFECT_PREFIX "native:"
+
+///
+/// Base class of effects implemented in C++. Native effects use the same definition files and args as
+/// python effects, the script of the definition is the native effect name with the NATIVE_EFFECT_PREFIX.
+/// They are rendered in the effect thread without a python interpreter. A frame is either one color per
+/// led or an image, which is mapped to the leds like the images of python effects.
+///
+class NativeEffect
+{
+public:
+	NativeEffect();
+	virtual ~NativeEffect();
+
+	///
+	/// @brief Create a native effect
+	/// @param script  The script of the effect definition, e.g. "native:knight-rider"
+	/// @return The effect or nullptr if there is no native effect with this name
+	///
+	static NativeEffect* create(const QString& script);
+
+	///
+	/// @param script  The script of an effect definition
+	/// @return True if the script addresses an available native effect
+	///
+	static bool isNative(const QString& script);
+
+	///
+	/// @return The scripts of all native effects
+	///
+	static QStringList availableEffects();
+
+	///
+	/// @brief Prepare the effect, called in the effect thread before the first frame
+	/// @param args       The args of the effect definition
+	/// @param ledCount   The number of leds
+	/// @param latchTime  The latch time of the led device in ms
+	/// @param imageSize  The size of the led layout, the initial canvas size
+	///
+	void setup(const QJsonObject& args, int ledCount, int latchTime, const QSize& imageSize);
+
+	///
+	/// @brief Render the next frame into colors() or image()
+	/// @return The time in ms until the next frame, negative to end the effect
+	///
+	virtual int render() = 0;
+
+	/// @return True if the last frame has been rendered into image()
+	bool hasImageOutput() const { return _imageOutput; }
+
+	/// @return The led colors of the last frame
+	const QVector<ColorRgb>& colors() const { return _colors; }
+
+	/// @return The image of the last frame
+	const QImage& image() const { return _image; }
+
+protected:
+	///
+	/// @brief Read the args, led count, latch time and canvas are already set
+	/// @param args  The args of the effect definition
+	///
+	virtual void init(const QJsonObject& args) = 0;
+
+	///
+	/// @brief Enlarge the canvas to a minimum size, keeps the aspect ratio like hyperion.imageMinSize()
+	///
+	void imageMinSize(int width, int height);
+
+	///
+	/// @brief Time between two frames, at least the latch time of the device
+	/// @param seconds  The time in seconds
+	/// @return The time in ms
+	///
+	int frameTime(double seconds) const;
+
+	///
+	/// @brief Read a color arg given as [r,g,b]
+	///
+	static ColorRgb toColor(const QJsonValue& value, const ColorRgb& defaultColor);
+
+	/// Number of leds
+	int _ledCount;
+
+	/// Latch time of the led device in ms
+	int _latchTime;
+
+	/// Led colors of the frame
+	QVector<ColorRgb> _colors;
+
+	/// Canvas of image based effects
+	QImage _image;
+
+	/// True if the frame is an image
+	bool _imageOutput;
+};
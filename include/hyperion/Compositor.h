@@ -0,0 +1,109 @@
+#pragma once
+
+// STL includes
+#include <vector>
+
+// Qt includes
+#include <QObject>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+#include <utils/Image.h>
+#include <utils/Logger.h>
+
+// settings
+#include <utils/settings.h>
+
+// Hyperion includes
+#include <hyperion/LedString.h>
+#include <hyperion/ImageToLedsMap.h>
+
+class Hyperion;
+
+///
+/// The Compositor blends the led colors of several visible priorities. Without compositing only the
+/// current priority is shown, with compositing the next lower priorities are shown below it, e.g.
+/// a notification effect which lights some leds over the screen capture.
+///
+class Compositor : public QObject
+{
+	Q_OBJECT
+
+public:
+	/// How a layer is blended over the layers below
+	enum BlendMode
+	{
+		/// Opacity weighted, black leds of the layer are transparent
+		BLEND_ALPHA,
+		/// Channel wise sum, saturated
+		BLEND_ADDITIVE,
+		/// Channel wise maximum
+		BLEND_MAX
+	};
+
+	///
+	/// @param[in] ledString  LedString data
+	/// @param[in] hyperion   Hyperion instance pointer
+	///
+	Compositor(const LedString& ledString, Hyperion* hyperion);
+	~Compositor();
+
+	///
+	/// @return The number of visible priorities to blend, 1 if compositing is disabled
+	///
+	int getLayerCount() const { return _enabled ? _layerCount : 1; }
+
+	///
+	/// @brief Update the led layout, the mapping of layer images is rebuild
+	/// @param ledString  The led string
+	///
+	void setLedString(const LedString& ledString);
+
+	///
+	/// @brief Blend a layer over the led colors of the layers below
+	/// @param[in]     ledColors  The led colors of the layer
+	/// @param[in,out] result     The led colors of the layers below, receives the blended colors
+	///
+	void blend(const std::vector<ColorRgb>& ledColors, std::vector<ColorRgb>& result) const;
+
+	///
+	/// @brief Blend a layer image over the led colors of the layers below. The image is mapped to the
+	///        leds without black border detection, so it doesn't disturb the detection of the base layer
+	/// @param[in]     image   The image of the layer
+	/// @param[in,out] result  The led colors of the layers below, receives the blended colors
+	///
+	void blend(const Image<ColorRgb>& image, std::vector<ColorRgb>& result);
+
+	///
+	/// @brief Convert a blend mode string to BlendMode, unknown modes are BLEND_ALPHA
+	///
+	static BlendMode stringToBlendMode(const QString& mode);
+
+private slots:
+	///
+	/// @brief Handle settings update from Hyperion Settingsmanager emit
+	/// @param type   settingyType from enum
+	/// @param config configuration object
+	///
+	void handleSettingsUpdate(const settings::type& type, const QJsonDocument& config);
+
+private:
+	/// Logger instance
+	Logger* _log;
+
+	/// The led string of the layer images
+	LedString _ledString;
+
+	/// Mapping of layer images, rebuild when the image size changes
+	hyperion::ImageToLedsMap* _imageToLeds;
+
+	/// Led colors of a layer image
+	std::vector<ColorRgb> _imageColors;
+
+	bool _enabled;
+	int _layerCount;
+	BlendMode _mode;
+
+	/// Opacity of alpha blended layers 0-256
+	unsigned _alpha;
+};
@@ -40,6 +40,7 @@ class QTimer;
 
 class HyperionDaemon;
 class ImageProcessor;
+class Compositor;
 class MessageForwarder;
 class LedDevice;
 class LinearColorSmoothing;
@@ -168,7 +169,7 @@ public:
 	///
 	/// @return The information of the given, a not found priority will return lowest priority as fallback
 	///
-	const InputInfo getPriorityInfo(const int priority) const;
+	const InputInfo& getPriorityInfo(const int priority) const;
 
 	/// Reload the list of available effects
 	void reloadEffects();
@@ -450,6 +451,12 @@ private slots:
 	///
 	void update();
 
+	///
+	/// @brief Update the composition when a priority has been removed or changed the active state, as it
+	///        might be a lower visible layer
+	///
+	void compositionChanged();
+
 	/// check for configWriteable and modified changes, called by _fsWatcher or fallback _cTimer
 	void checkConfigState(QString cfile = NULL);
 
@@ -468,6 +475,12 @@ private slots:
 	void handleSettingsUpdate(const settings::type& type, const QJsonDocument& config);
 
 private:
+	///
+	/// @brief Check if a priority is shown, the current one or a lower layer of the composition
+	/// @param priority  The priority
+	/// @return True if the priority is visible
+	///
+	bool isVisiblePriority(const int priority) const;
 
 	///
 	/// Constructs the Hyperion instance based on the given Json configuration
@@ -494,6 +507,9 @@ private:
 	/// Image Processor
 	ImageProcessor* _imageProcessor;
 
+	/// Blends the visible priorities
+	Compositor* _compositor;
+
 	std::vector<ColorOrder> _ledStringColorOrder;
 
 	/// The priority muxer
@@ -536,6 +552,9 @@ private:
 	/// Store the previous compID for smarter update()
 	hyperion::Components   _prevCompId;
 
+	/// Store the previous compID of the base layer, which configures the image processing
+	hyperion::Components   _prevBaseCompId;
+
 	/// Observe filesystem changes (_configFile), if failed use Timer
 	QFileSystemWatcher _fsWatcher;
 	QTimer* _cTimer;
@@ -90,7 +90,7 @@ namespace hyperion
 			//assert(_colorsMap.size() == ledColors.size());
 			if(_colorsMap.size() != ledColors.size())
 			{
-				Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: colorsMap.size != ledColors.size -> %d != %d", _colorsMap.size(), ledColors.size());
+				Debug(_log, "ImageToLedsMap: colorsMap.size != ledColors.size -> %d != %d", _colorsMap.size(), ledColors.size());
 				return;
 			}
 
@@ -133,7 +133,7 @@ namespace hyperion
 			// assert(_colorsMap.size() == ledColors.size());
 			if(_colorsMap.size() != ledColors.size())
 			{
-				Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: colorsMap.size != ledColors.size -> %d != %d", _colorsMap.size(), ledColors.size());
+				Debug(_log, "ImageToLedsMap: colorsMap.size != ledColors.size -> %d != %d", _colorsMap.size(), ledColors.size());
 				return;
 			}
 
@@ -144,6 +144,8 @@ namespace hyperion
 		}
 
 	private:
+		/// The logger, looked up once instead of per frame
+		Logger* _log;
 		/// The width of the indexed image
 		const unsigned _width;
 		/// The height of the indexed image
@@ -8,6 +8,7 @@
 
 // QT includes
 #include <QList>
+#include <QMap>
 #include <QStringList>
 #include <QHostAddress>
 #include <QJsonObject>
@@ -17,9 +18,11 @@
 // Utils includes
 #include <utils/ColorRgb.h>
 #include <utils/settings.h>
+#include <utils/Components.h>
 #include <utils/Logger.h>
 
 class Hyperion;
+class MulticastPublisher;
 
 class MessageForwarder : public QObject
 {
@@ -31,6 +34,7 @@ public:
 
 	void addJsonSlave(QString slave);
 	void addProtoSlave(QString slave);
+	void setMulticastTarget(const QString& target);
 
 	bool protoForwardingEnabled();
 	bool jsonForwardingEnabled();
@@ -38,6 +42,31 @@ public:
 	QStringList getProtoSlaves() const { return _protoSlaves; };
 	QStringList getJsonSlaves() const { return _jsonSlaves; };
 
+	///
+	/// @return The multicast group and port, empty if multicast publishing is disabled
+	///
+	QString getMulticastTarget() const;
+
+	///
+	/// @brief Publish the led colors to the multicast group, if the forwarder is enabled
+	/// @param ledColors  The led colors before the color adjustments
+	///
+	void publishLedColors(const std::vector<ColorRgb>& ledColors);
+
+	///
+	/// @brief Account a frame forwarded to a proto target
+	/// @param target        The target address
+	/// @param bytesWritten  The bytes written to the target since its connection has been created
+	/// @param cpuNs         The cpu time spend for the target to process the frame in ns
+	/// @param skipped       True if the frame has been skipped as unchanged
+	///
+	void addProtoStatistics(const QString& target, qint64 bytesWritten, qint64 cpuNs, bool skipped);
+
+	///
+	/// @return The frames, bytes, bandwidth and cpu time per frame of each proto target
+	///
+	QJsonArray getProtoStatistics() const;
+
 private slots:
 	///
 	/// @brief Handle settings update from Hyperion Settingsmanager emit or this constructor
@@ -46,9 +75,36 @@ private slots:
 	///
 	void handleSettingsUpdate(const settings::type& type, const QJsonDocument& config);
 
+	///
+	/// @brief Track the forwarder component state
+	/// @param component  The component
+	/// @param enable     The new state
+	///
+	void componentStateChanged(const hyperion::Components component, bool enable);
+
 private:
+	/// Counters of a proto target, the rates are measured over windows of a second
+	struct ProtoStatistics
+	{
+		qint64 frames = 0;
+		qint64 skipped = 0;
+		qint64 bytes = 0;
+		qint64 cpuNs = 0;
+
+		qint64 windowStart = 0;
+		qint64 windowFrames = 0;
+		qint64 windowBytes = 0;
+		qint64 windowCpuNs = 0;
+
+		double bytesPerSecond = 0;
+		double cpuUsPerFrame = 0;
+	};
+
 	Hyperion* _hyperion;
 	Logger*   _log;
 	QStringList   _protoSlaves;
 	QStringList   _jsonSlaves;
+	MulticastPublisher* _multicastPublisher;
+	bool _forwarderEnabled;
+	QMap<QString, ProtoStatistics> _protoStatistics;
 };
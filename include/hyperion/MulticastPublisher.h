@@ -0,0 +1,92 @@
+#pragma once
+
+// STL includes
+#include <vector>
+#include <cstdint>
+
+// Qt includes
+#include <QObject>
+#include <QByteArray>
+#include <QHostAddress>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+#include <utils/Logger.h>
+
+class QUdpSocket;
+
+/* Multicast frame datagram, all fields big endian:
+ *  0  magic 'H' 'M'
+ *  2  version
+ *  3  flags, reserved
+ *  4  uint32 session, random per publisher instance
+ *  8  uint32 frame sequence, starts at 0 per session
+ * 12  uint16 fragment index
+ * 14  uint16 fragment count
+ * 16  uint32 frame size in bytes
+ * 20  rgb payload of the fragment, starts at fragment index * MULTICAST_FRAGMENT_SIZE of the frame
+ */
+#define MULTICAST_MAGIC_0 'H'
+#define MULTICAST_MAGIC_1 'M'
+#define MULTICAST_VERSION 2
+#define MULTICAST_HEADER_SIZE 20
+
+/// Payload of a fragment, a multiple of 3 which keeps the datagrams below the ethernet MTU
+#define MULTICAST_FRAGMENT_SIZE 1200
+
+///
+/// Publishes led frames to a UDP multicast group. Each frame is sent once regardless of the number of
+/// receivers, which subscribe with a UDPListener of the protocol "multicast". Frames larger than a
+/// datagram are split into fragments, the sequence number lets the receivers drop incomplete frames.
+///
+class MulticastPublisher : public QObject
+{
+	Q_OBJECT
+
+public:
+	MulticastPublisher(QObject* parent = nullptr);
+	~MulticastPublisher();
+
+	///
+	/// @brief Set the multicast group
+	/// @param target  The group and port like "239.255.28.2:19450", an empty string disables publishing
+	/// @return False if the target is no multicast address
+	///
+	bool setTarget(const QString& target);
+
+	///
+	/// @return True if a multicast group is set
+	///
+	bool enabled() const { return _port != 0; }
+
+	///
+	/// @return The group and port, empty if disabled
+	///
+	QString getTarget() const;
+
+	///
+	/// @brief Publish a frame, the sequence number is incremented per frame
+	/// @param ledColors  The led colors
+	///
+	void publish(const std::vector<ColorRgb>& ledColors);
+
+	///
+	/// @return The sequence number of the next frame
+	///
+	quint32 getSequence() const { return _sequence; }
+
+private:
+	Logger* _log;
+	QUdpSocket* _socket;
+	QHostAddress _group;
+	quint16 _port;
+
+	/// Random session, tells the receivers that the sequence numbers start again
+	quint32 _session;
+
+	/// Sequence number of the next frame
+	quint32 _sequence;
+
+	/// Preallocated datagram
+	QByteArray _datagram;
+};
@@ -2,6 +2,8 @@
 
 // STL includes
 #include <vector>
+#include <queue>
+#include <functional>
 #include <cstdint>
 
 // QT includes
@@ -71,7 +73,7 @@ public:
 	~PriorityMuxer();
 
 	///
-	/// @brief Start/Stop the PriorityMuxer update timer; On disabled no priority and timeout updates will be performend
+	/// @brief Start/Stop the PriorityMuxer timeout timer; On disabled no priority and timeout updates will be performend
 	/// @param  enable  The new state
 	///
 	void setEnable(const bool& enable);
@@ -109,6 +111,14 @@ public:
 	///
 	int getCurrentPriority() const;
 
+	///
+	/// @brief Get the visible priorities for compositing, the current priority followed by the next lower
+	///        active priorities. The lowest priority is only included if it is the current one
+	/// @param  count  The maximum number of priorities
+	/// @return The priorities, starting with the current one
+	///
+	QList<int> getVisiblePriorities(const int count) const;
+
 	///
 	/// Returns the state (enabled/disabled) of a specific priority channel
 	/// @param priority The priority channel
@@ -129,9 +139,9 @@ public:
 	///
 	/// @param priority The priority channel
 	///
-	/// @return The information for the specified priority channel
+	/// @return The information for the specified priority channel, valid until the channel is updated or cleared
 	///
-	const InputInfo getInputInfo(const int priority) const;
+	const InputInfo& getInputInfo(const int priority) const;
 
 	///
 	/// @brief  Register a new input by priority, the priority is not active (timeout -100 isn't muxer recognized) until you start to update the data with setInput()
@@ -233,22 +243,83 @@ private slots:
 
 	///
 	/// Updates the current time. Channels with a configured time out will be checked and cleared if
-	/// required.
+	/// required. Called when the earliest timeout is due and whenever the active inputs change.
 	///
 	void setCurrentTime(void);
 
 private:
+	///
+	/// Bitmap with one bit per priority, finds the lowest set priority with a few word operations
+	///
+	class PriorityBitmap
+	{
+	public:
+		PriorityBitmap() { clear(); }
+
+		void set(const int priority)   { if (priority >= 0 && priority < 256) _words[priority >> 6] |=  (Q_UINT64_C(1) << (priority & 63)); }
+		void reset(const int priority) { if (priority >= 0 && priority < 256) _words[priority >> 6] &= ~(Q_UINT64_C(1) << (priority & 63)); }
+		bool test(const int priority) const { return priority >= 0 && priority < 256 && ((_words[priority >> 6] >> (priority & 63)) & 1); }
+		bool any() const { return (_words[0] | _words[1] | _words[2] | _words[3]) != 0; }
+		void clear() { _words[0] = _words[1] = _words[2] = _words[3] = 0; }
+
+		///
+		/// @param from  The first priority to check
+		/// @return The lowest set priority >= from, -1 if there is none
+		///
+		int next(const int from) const;
+
+	private:
+		quint64 _words[4];
+	};
+
+	/// A pending timeout, the absolute time and the priority
+	typedef std::pair<int64_t, int> Timeout;
+
+	///
+	/// @brief Set the timeout of an input and update the active state and the pending timeouts
+	/// @param input       The input
+	/// @param timeout_ms  The absolute timeout, -1 endless or -100 inactive
+	/// @return True if the active state has changed
+	///
+	bool setTimeout(InputInfo& input, const int64_t timeout_ms);
+
+	///
+	/// @brief Remove an input and free its data
+	/// @param priority  The priority of the input
+	///
+	void removeInput(const int priority);
+
+	///
+	/// @brief Arm the timeout timer for the earliest pending timeout, stop it if there is none
+	///
+	void scheduleTimeout();
+
 	/// Logger instance
 	Logger* _log;
 
-	/// The current priority (lowest value in _activeInputs)
+	/// The current priority (lowest active priority)
 	int _currentPriority;
 
 	/// The manual select priority set with setPriority
 	int _manualSelectedPriority;
 
-	/// The mapping from priority channel to led-information
-	QMap<int, InputInfo> _activeInputs;
+	/// The inputs indexed by priority, only registered slots are valid
+	InputInfo _inputs[256];
+
+	/// Registered priorities
+	PriorityBitmap _registered;
+
+	/// Registered priorities which are active, inputs registered with timeout -100 are awaiting data
+	PriorityBitmap _active;
+
+	/// Active COLOR and EFFECT priorities with a timeout, they trigger the timeRunner
+	PriorityBitmap _timeRunning;
+
+	/// Pending timeouts, earliest first. Outdated entries are skipped when they are due
+	std::priority_queue<Timeout, std::vector<Timeout>, std::greater<Timeout>> _timeouts;
+
+	/// The timeout per priority which has an entry in _timeouts, 0 if there is none
+	int64_t _queuedTimeouts[256];
 
 	/// The information of the lowest priority channel
 	InputInfo _lowestPriorityInfo;
@@ -256,8 +327,11 @@ private:
 	// Reflect the state of auto select
 	bool _sourceAutoSelectEnabled;
 
-	// Timer to update Muxer times independent
-	QTimer* _updateTimer;
+	// Reflect the state of setEnable
+	bool _enabled;
+
+	// Single shot timer, fires when the earliest pending timeout is due
+	QTimer* _timeoutTimer;
 
 	QTimer* _timer;
 	QTimer* _blockTimer;
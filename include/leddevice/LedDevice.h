@@ -114,6 +114,9 @@ protected:
 	unsigned int _refresh_timer_interval;
 	qint64       _last_write_time;
 	unsigned int _latchTime_ms;
+
+	/// Account the writes to the latency tracer and the metrics, disabled for devices which feed another device
+	bool _traceLatency;
 protected slots:
 	/// Write the last data to the leds again
 	int rewriteLeds();
@@ -7,6 +7,8 @@
 #include <QTcpSocket>
 #include <QTimer>
 #include <QMap>
+#include <QByteArray>
+#include <QSharedMemory>
 
 // hyperion util
 #include <utils/Image.h>
@@ -19,7 +21,9 @@
 #include <hyperion_request_generated.h>
 
 ///
-/// Connection class to setup an connection to the hyperion server and execute commands
+/// Connection class to setup an connection to the hyperion server and execute commands.
+/// Messages are sent without blocking. While the server is busy, images and led colors are held in a
+/// queue of one frame which is replaced by newer frames, so a slow server never stalls the sender.
 ///
 class ProtoConnection : public QObject
 {
@@ -27,6 +31,17 @@ class ProtoConnection : public QObject
 	Q_OBJECT
 
 public:
+	/// Encoding of the images sent with setImage
+	enum ImageEncoding
+	{
+		/// The pixels
+		ENCODING_RAW,
+		/// zlib compressed pixels
+		ENCODING_COMPRESSED,
+		/// zlib compressed difference to the previous image, the first image of a connection is compressed
+		ENCODING_DELTA
+	};
+
 	///
 	/// Constructor
 	///
@@ -39,9 +54,44 @@ public:
 	///
 	~ProtoConnection();
 
-	/// Do not read reply messages from Hyperion if set to true
+	/// Do not read reply messages from Hyperion if set to true, frames are then only limited by the socket.
+	/// The registration asks the server to send only errors and heartbeats
 	void setSkipReply(bool skip);
 
+	///
+	/// Register the priority of the following commands, the registration is sent with each (re)connect
+	///
+	/// @param origin The origin, the server appends the host name of the client
+	/// @param priority The priority
+	///
+	void setRegister(const QString & origin, int priority);
+
+	///
+	/// Set the encoding of the following images, compressed images need a server which supports them
+	///
+	/// @param encoding The encoding
+	///
+	void setImageEncoding(ImageEncoding encoding);
+
+	///
+	/// Hand images to a server on the same host through a shared memory segment instead of the socket.
+	/// The segment is announced with the first image, images are sent through the socket until the server
+	/// has attached to it and whenever all slots are in use
+	///
+	/// @param enable True to use shared memory for servers on the same host
+	///
+	void setSharedMemory(bool enable);
+
+	///
+	/// @return The address of the Hyperion server as host:port
+	///
+	QString getAddress() const;
+
+	///
+	/// @return The number of bytes written to the socket since the connection object has been created
+	///
+	qint64 getBytesWritten() const { return _bytesWritten; }
+
 	///
 	/// Set all leds to the specified color
 	///
@@ -58,6 +108,15 @@ public:
 	///
 	void setImage(const Image<ColorRgb> & image, int duration = -1);
 
+	///
+	/// Set the colors of consecutive leds, leds outside of the given range keep their last color
+	///
+	/// @param ledColors The colors
+	/// @param offset The index of the first led to update
+	/// @param duration The duration in milliseconds
+	///
+	void setLedColors(const std::vector<ColorRgb> & ledColors, int offset = 0, int duration = -1);
+
 	///
 	/// Clear the given priority channel
 	///
@@ -71,9 +130,11 @@ public:
 	void clearAll();
 
 	///
-	/// Send a command message and receive its reply
+	/// Send a verified request message, the reply is received asynchronously. Images and led colors
+	/// replace the queued frame if the server is busy
 	///
-	/// @param message The message to send
+	/// @param buffer The message to send
+	/// @param size The size of the message
 	///
 	void sendMessage(const uint8_t* buffer, uint32_t size);
 
@@ -86,6 +147,16 @@ private slots:
 	///
 	void readData();
 
+	///
+	/// Send the queued frame if the server is ready for it
+	///
+	void sendQueuedFrame();
+
+	///
+	/// Send the registration, called when the connection has been established
+	///
+	void sendRegister();
+
 signals:
 
 	///
@@ -104,6 +175,69 @@ private:
 	///
 	bool parseReply(const hyperionnet::Reply * reply);
 
+	///
+	/// Finish the request of the builder, send it and clear the builder for the next request
+	///
+	/// @param request The request built with _builder
+	///
+	void sendRequest(const flatbuffers::Offset<hyperionnet::Request> & request);
+
+	///
+	/// @return true if a frame can be sent now: the socket has written the previous data and, unless replies
+	///         are skipped, not more than MAX_PENDING_REPLIES requests are awaiting their reply
+	///
+	bool isReadyForFrame() const;
+
+	///
+	/// Send an image through the shared memory or encoded with the image encoding
+	///
+	/// @param image The image
+	/// @param duration The duration in milliseconds
+	///
+	void sendImage(const Image<ColorRgb> & image, int duration);
+
+	///
+	/// Write an image into a free slot of the shared memory segment and send its SharedImage request
+	///
+	/// @param image The image
+	/// @param duration The duration in milliseconds
+	///
+	/// @return false if the image has to be sent through the socket
+	///
+	bool sendSharedImage(const Image<ColorRgb> & image, int duration);
+
+	///
+	/// Create a shared memory segment for images up to the given size and announce it to the server
+	///
+	/// @param imageSize The size of the images in bytes
+	///
+	void createSharedMemory(int imageSize);
+
+	///
+	/// Send an image as RawImage
+	///
+	/// @param image The image
+	/// @param duration The duration in milliseconds
+	///
+	void sendRawImage(const Image<ColorRgb> & image, int duration);
+
+	///
+	/// Encode an image with the image encoding and send it
+	///
+	/// @param image The image
+	/// @param duration The duration in milliseconds
+	///
+	void sendEncodedImage(const Image<ColorRgb> & image, int duration);
+
+	///
+	/// Write a message with its size header to the socket
+	///
+	/// @param buffer The message
+	/// @param size The size of the message
+	/// @param expectReply true if the server replies to the message
+	///
+	void writeMessage(const char* buffer, uint32_t size, bool expectReply);
+
 private:
 	/// The TCP-Socket with the connection to the server
 	QTcpSocket _socket;
@@ -121,5 +255,49 @@ private:
 	QAbstractSocket::SocketState  _prevSocketState;
 
 	Logger * _log;
-	flatbuffers::FlatBufferBuilder builder;
+
+	/// Builder of the requests, cleared after each request to reuse its buffer
+	flatbuffers::FlatBufferBuilder _builder;
+
+	/// Received data which doesn't form a complete reply yet
+	QByteArray _receiveBuffer;
+
+	/// The latest frame which couldn't be sent yet, empty if there is none
+	QByteArray _queuedFrame;
+
+	/// Number of sent requests which haven't been replied yet
+	int _pendingReplies;
+
+	/// Origin and priority of the registration, no registration is sent for priority -1
+	QString _origin;
+	int _priority;
+
+	/// Encoding of the images
+	ImageEncoding _imageEncoding;
+
+	/// The pixels of the last delta encoded image, the base of the next difference
+	QByteArray _deltaBase;
+
+	/// The latest image which couldn't be encoded and sent yet, with its duration
+	Image<ColorRgb> _queuedImage;
+	int _queuedImageDuration;
+	bool _imageQueued;
+
+	/// Number of bytes written to the socket
+	qint64 _bytesWritten;
+
+	/// Use shared memory for a server on the same host
+	bool _useSharedMemory;
+
+	/// The shared memory segment of the connection, nullptr until the first image
+	QSharedMemory * _sharedMemory;
+
+	/// Size of the slots of the segment
+	int _sharedMemorySlotSize;
+
+	/// True once the server has attached to the segment
+	bool _sharedMemoryAttached;
+
+	/// The slot to try first for the next image
+	int _sharedMemorySlot;
 };
@@ -87,8 +87,23 @@ private slots:
 	/// @param connection The Connection object which is being closed
 	///
 	void newMessage(const uint8_t* buffer , uint32_t size);
+	///
+	/// Slot which is called when a client has sent an image through shared memory
+	/// @param image The image
+	/// @param duration The duration in milliseconds
+	///
+	void newImage(const Image<ColorRgb> & image, int duration);
 
 private:
+	///
+	/// @brief Forward an image downscaled, without unchanged images and encoded as configured
+	/// @param pixels The pixels of the image of a proto client
+	/// @param width The width of the image
+	/// @param height The height of the image
+	/// @param duration The duration in milliseconds
+	///
+	void forwardImage(const ColorRgb * pixels, int width, int height, int duration);
+
 	/// Hyperion instance
 	Hyperion * _hyperion;
 
@@ -117,6 +132,20 @@ private:
 	/// flag if forwarder is enabled
 	bool _forwarder_enabled;
 
+	/// Maximum size of forwarded images, 0 keeps the size
+	int _forwardImageWidth;
+	int _forwardImageHeight;
+
+	/// Skip forwarded images which are equal to the previous one
+	bool _forwardSkipUnchanged;
+
+	/// True if forwarded images are downscaled, skipped or encoded instead of relayed
+	bool _forwardImageProcessing;
+
+	/// The last forwarded image and the time it has been forwarded
+	Image<ColorRgb> _lastForwardedImage;
+	qint64 _lastForwardTime;
+
 	uint16_t _port = 0;
 
 	/// Start server
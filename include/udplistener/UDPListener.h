@@ -3,9 +3,16 @@
 // system includes
 #include <cstdint>
 
+// stl includes
+#include <vector>
+
 // Qt includes
 #include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QByteArray>
 #include <QHostAddress>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 
 // Hyperion includes
@@ -19,9 +26,10 @@
 class BonjourServiceRegister;
 class QUdpSocket;
 class NetOrigin;
+class UdpDecoder;
 
 ///
-/// This class creates a UDP server which accepts connections from boblight clients.
+/// This class creates a UDP server which accepts led data as raw rgb, E1.31, Art-Net or DDP packets.
 ///
 class UDPListener : public QObject
 {
@@ -84,12 +92,33 @@ signals:
 
 private slots:
 	///
-	/// Slot which is called when a client tries to create a new connection
+	/// Slot which is called when datagrams are pending. Drains the socket into the preallocated
+	/// receive buffer, keeps only the newest complete frame of each sender and forwards them once per call
 	///
 	void readPendingDatagrams();
-	void processTheDatagram(const QByteArray * datagram, const QHostAddress * sender);
 
 private:
+	///
+	/// Pass a datagram to the protocol decoder of the sender
+	/// @param data    The datagram payload
+	/// @param size    The payload size in bytes
+	/// @param sender  The sender of the datagram
+	///
+	void processTheDatagram(const char* data, const qint64& size, const QHostAddress& sender);
+
+	///
+	/// Register the sender at the muxer (if required) and forward its newest frame
+	/// @param sender     The sender
+	/// @param ledColors  The colors of the newest frame
+	///
+	void forwardFrame(const QHostAddress& sender, const std::vector<ColorRgb>& ledColors);
+
+	///
+	/// Delete the decoders of senders without a datagram within the timeout
+	/// @param now  The current time of _clock
+	///
+	void removeIdleSenders(qint64 now);
+
 	/// The UDP server object
 	QUdpSocket * _server;
 
@@ -115,4 +144,35 @@ private:
 
 	/// Check Network Origin
 	NetOrigin* _netOrigin;
+
+	/// Preallocated buffer for a single datagram, reused for every read
+	QByteArray _datagramBuffer;
+
+	/// The protocol of incoming datagrams (raw, e131, artnet, ddp)
+	QString _protocol;
+
+	/// The udpListener configuration, passed to new decoders
+	QJsonObject _config;
+
+	/// Protocol decoder of each sender, holds the newest complete frame
+	QHash<QHostAddress, UdpDecoder*> _decoders;
+
+	/// Time of the last datagram of each sender
+	QHash<QHostAddress, qint64> _lastDatagram;
+
+	/// Clock of the datagram times and of the last removal of idle senders
+	QElapsedTimer _clock;
+	qint64 _lastIdleCheck = 0;
+
+	/// Senders beyond the limit have been ignored since the last removal
+	bool _senderLimitReached = false;
+
+	/// Senders with a new complete frame in the current read cycle, in order of arrival
+	QVector<QHostAddress> _pendingSenders;
+
+	/// The sender which is currently registered as origin at the muxer
+	QHostAddress _registeredSender;
+
+	/// Time since the last forwarded frame, used to detect a muxer timeout of the registered input
+	QElapsedTimer _lastFrameTimer;
 };
@@ -65,4 +65,19 @@ public:
 	/// number and scaled between 0 and 360
 	///
 	static void hsv2rgb(uint16_t hue, uint8_t saturation, uint8_t value, uint8_t & red, uint8_t & green, uint8_t & blue);
+
+	///
+	///	Translates an HSV (hue, saturation, value) color to an RGB (red, green, blue) color like colorsys.hsv_to_rgb of python
+	///
+	/// @param[in] hue The hue HSV-component between 0 and 1, wraps around
+	/// @param[in] saturation The saturation HSV-component between 0 and 1, clamped
+	/// @param[in] value The value HSV-component between 0 and 1, clamped
+	/// @param[out] red The red RGB-component
+	/// @param[out] green The green RGB-component
+	/// @param[out] blue The blue RGB-component
+	///
+	/// @note The RGB-components are truncated like int(255 * component) in python, so effects ported from python
+	/// produce the same colors
+	///
+	static void hsv2rgb(double hue, double saturation, double value, uint8_t & red, uint8_t & green, uint8_t & blue);
 };
@@ -0,0 +1,120 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+
+// Qt includes
+#include <QJsonObject>
+
+// utils includes
+#include <utils/Components.h>
+
+///
+/// Always available timing of the stages of the pipeline from the capture of a frame to the write of the
+/// led device. Each stage aggregates its durations into a histogram with buckets of powers of two microseconds.
+/// Recording is lock free and costs two clock reads and a few relaxed atomic increments.
+///
+class LatencyTracer
+{
+public:
+	/// The stages of the pipeline
+	enum Stage
+	{
+		/// Processing of a captured frame by the grabber, including the resampling
+		GRAB,
+		/// Conversion of the pixel format and decimation of a captured frame
+		RESAMPLE,
+		/// Storing an input in the priority muxer
+		MUX,
+		/// Mapping of the visible image to led colors, including the blending of the layers
+		MAP,
+		/// Color adjustments and led order
+		ADJUST,
+		/// Interpolation of the smoothing
+		SMOOTH,
+		/// Write of the led device
+		WRITE,
+		/// From the capture of a frame to the first device write after it has been shown
+		END_TO_END,
+		STAGE_COUNT
+	};
+
+	/// Number of histogram buckets, bucket 0 counts durations below 1us, bucket n durations below 2^n us,
+	/// the last one all longer ones
+	static const int BUCKETS = 24;
+
+	///
+	/// @return A monotonic timestamp in ns
+	///
+	static int64_t now();
+
+	///
+	/// @brief Account a duration of a stage
+	/// @param stage     The stage
+	/// @param duration  The duration in ns
+	///
+	static void record(Stage stage, int64_t duration);
+
+	///
+	/// @brief Note the capture time of the newest frame, the next device write accounts END_TO_END
+	/// @param timestamp  The capture time from now()
+	/// @param component  The component which sets the captured frame as input
+	///
+	static void markCapture(int64_t timestamp, hyperion::Components component);
+
+	///
+	/// @brief Forget the capture time if it has been marked by the component, its frame will not be shown
+	/// @param component  The component of an input which is not visible
+	///
+	static void discardCapture(hyperion::Components component);
+
+	///
+	/// @brief Note a device write, accounts END_TO_END for a captured frame
+	///
+	static void markWrite();
+
+	///
+	/// @return The name of the stage
+	///
+	static const char* stageName(Stage stage);
+
+	///
+	/// @brief Get a snapshot of the histogram of a stage
+	/// @param stage         The stage
+	/// @param[out] buckets  The sample count of each of the BUCKETS buckets
+	/// @param[out] sum      The sum of all durations in ns
+	///
+	static void getHistogram(Stage stage, uint64_t* buckets, uint64_t& sum);
+
+	///
+	/// @return The count, average, maximum, percentiles and histogram of each stage
+	///
+	static QJsonObject getMetrics();
+
+	///
+	/// @brief Clear the histograms of all stages
+	///
+	static void reset();
+};
+
+///
+/// Accounts the time between its construction and destruction to a stage
+///
+class LatencyScope
+{
+public:
+	LatencyScope(LatencyTracer::Stage stage)
+		: _stage(stage)
+		, _start(LatencyTracer::now())
+	{
+	}
+
+	~LatencyScope()
+	{
+		LatencyTracer::record(_stage, LatencyTracer::now() - _start);
+	}
+
+private:
+	const LatencyTracer::Stage _stage;
+	const int64_t _start;
+};
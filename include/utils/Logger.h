@@ -7,25 +7,29 @@
 // stl includes
 #include <stdio.h>
 #include <stdarg.h>
+#include <atomic>
 #include <map>
+#include <string>
 #include <QVector>
 
 #include <utils/global_defines.h>
 
-// standard log messages
+// standard log messages, the arguments are only evaluated if the logger writes the level
 //#define _FUNCNAME_ __PRETTY_FUNCTION__
 #define _FUNCNAME_ __FUNCTION__
 
-#define Debug(logger, ...)   { (logger)->Message(Logger::DEBUG  , __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__); }
-#define Info(logger, ...)    { (logger)->Message(Logger::INFO   , __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__); }
-#define Warning(logger, ...) { (logger)->Message(Logger::WARNING, __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__); }
-#define Error(logger, ...)   { (logger)->Message(Logger::ERROR  , __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__); }
+#define LogMessage(level, logger, ...) { Logger* const logMessageLogger = (logger); if (logMessageLogger->isEnabled(level)) {logMessageLogger->Message(level, __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__);} }
+
+#define Debug(logger, ...)   LogMessage(Logger::DEBUG  , logger, __VA_ARGS__)
+#define Info(logger, ...)    LogMessage(Logger::INFO   , logger, __VA_ARGS__)
+#define Warning(logger, ...) LogMessage(Logger::WARNING, logger, __VA_ARGS__)
+#define Error(logger, ...)   LogMessage(Logger::ERROR  , logger, __VA_ARGS__)
 
 // conditional log messages
-#define DebugIf(condition, logger, ...)   { if (condition) {(logger)->Message(Logger::DEBUG   , __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__);} }
-#define InfoIf(condition, logger, ...)    { if (condition) {(logger)->Message(Logger::INFO    , __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__);} }
-#define WarningIf(condition, logger, ...) { if (condition) {(logger)->Message(Logger::WARNING , __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__);} }
-#define ErrorIf(condition, logger, ...)   { if (condition) {(logger)->Message(Logger::ERROR   , __FILE__, _FUNCNAME_, __LINE__, __VA_ARGS__);} }
+#define DebugIf(condition, logger, ...)   { if (condition) LogMessage(Logger::DEBUG   , logger, __VA_ARGS__) }
+#define InfoIf(condition, logger, ...)    { if (condition) LogMessage(Logger::INFO    , logger, __VA_ARGS__) }
+#define WarningIf(condition, logger, ...) { if (condition) LogMessage(Logger::WARNING , logger, __VA_ARGS__) }
+#define ErrorIf(condition, logger, ...)   { if (condition) LogMessage(Logger::ERROR   , logger, __VA_ARGS__) }
 
 // ================================================================
 
@@ -54,9 +58,25 @@ public:
 	static void     setLogLevel(LogLevel level, QString name="");
 	static LogLevel getLogLevel(QString name="");
 
+	///
+	/// @brief Wait until the background writer has written all queued messages
+	///
+	static void     flush();
+
+	///
+	/// @brief Check whether this logger writes messages of a level, the global level overrides the one of the logger
+	/// @param level  The level
+	/// @return False if the message would be discarded
+	///
+	bool     isEnabled(LogLevel level) const
+	{
+		const int globalLevel = GLOBAL_MIN_LOG_LEVEL.load(std::memory_order_relaxed);
+		return level >= (globalLevel == Logger::UNSET ? _minLevel.load(std::memory_order_relaxed) : globalLevel);
+	};
+
 	void     Message(LogLevel level, const char* sourceFile, const char* func, unsigned int line, const char* fmt, ...);
 	void     setMinLevel(LogLevel level) { _minLevel = level; };
-	LogLevel getMinLevel() { return _minLevel; };
+	LogLevel getMinLevel() { return LogLevel(_minLevel.load(std::memory_order_relaxed)); };
 
 signals:
 	void newLogMessage(Logger::T_LOG_MESSAGE);
@@ -66,12 +86,19 @@ protected:
 	~Logger();
 
 private:
+	friend class LogWriter;
+
+	///
+	/// @brief Emit a formatted message to the LoggerManager, append its console line to the output and send it to syslog
+	///
+	void write(LogLevel level, const char* sourceFile, const char* func, unsigned int line, time_t utime, const char* msg, std::string& output);
+
 	static std::map<QString,Logger*> *LoggerMap;
-	static LogLevel GLOBAL_MIN_LOG_LEVEL;
+	static std::atomic<int> GLOBAL_MIN_LOG_LEVEL;
 
 	QString  _name;
 	QString  _appname;
-	LogLevel _minLevel;
+	std::atomic<int> _minLevel;
 	bool     _syslogEnabled;
 	unsigned _loggerId;
 };
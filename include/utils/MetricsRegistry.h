@@ -0,0 +1,78 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+
+///
+/// Registry of counters and gauges which the pipeline updates with relaxed atomics, without locks.
+/// The web server exposes them together with the latency histograms of the LatencyTracer at /metrics.
+///
+class MetricsRegistry
+{
+public:
+	/// Monotonic counters
+	enum Counter
+	{
+		/// Effect outputs replaced before the main thread picked them up
+		DROPPED_EFFECT,
+		/// UDP listener frames superseded by a newer frame of the same sender
+		DROPPED_UDP,
+		/// Proto frames replaced by a newer one while the target was busy
+		DROPPED_FORWARDER,
+		/// Led device writes skipped within the latch time
+		DROPPED_LATCH,
+		/// Led device writes which failed
+		DEVICE_WRITE_ERRORS,
+		/// CPU time of the effect threads in ns
+		EFFECT_CPU_NS,
+		COUNTER_COUNT
+	};
+
+	/// Current values
+	enum Gauge
+	{
+		/// Frames in the output delay queue of the smoothing
+		SMOOTHING_QUEUE_DEPTH,
+		GAUGE_COUNT
+	};
+
+	///
+	/// @brief Increase a counter
+	/// @param counter  The counter
+	/// @param value    The increment
+	///
+	static void add(Counter counter, uint64_t value = 1);
+
+	///
+	/// @return The value of the counter
+	///
+	static uint64_t get(Counter counter);
+
+	///
+	/// @brief Set a gauge
+	/// @param gauge  The gauge
+	/// @param value  The value
+	///
+	static void set(Gauge gauge, int64_t value);
+
+	///
+	/// @return The value of the gauge
+	///
+	static int64_t get(Gauge gauge);
+
+	///
+	/// @brief Count an input of a priority
+	/// @param priority  The priority 0-255
+	///
+	static void addPriorityFrame(int priority);
+
+	///
+	/// @return The number of inputs of the priority
+	///
+	static uint64_t getPriorityFrames(int priority);
+
+	///
+	/// @return The CPU time of the calling thread in ns, 0 if the platform doesn't provide it
+	///
+	static int64_t threadCpuTime();
+};
@@ -24,9 +24,11 @@
 #include <utils/ColorSys.h>
 #include <leddevice/LedDevice.h>
 #include <hyperion/GrabberWrapper.h>
+#include <hyperion/MessageForwarder.h>
 #include <utils/Process.h>
 #include <utils/JsonUtils.h>
 #include <utils/Stats.h>
+#include <utils/LatencyTracer.h>
 
 // bonjour wrapper
 #include <bonjour/bonjourbrowserwrapper.h>
@@ -149,6 +151,7 @@ void JsonAPI::handleMessage(const QString& messageString, const QString& httpAut
 	else if (command == "processing")     handleProcessingCommand    (message, command, tan);
 	else if (command == "videomode")      handleVideoModeCommand     (message, command, tan);
 	else if (command == "plugin")         handlePluginCommand        (message, command, tan);
+	else if (command == "metrics")        handleMetricsCommand       (message, command, tan);
 	else                                  handleNotImplemented       ();
 }
 
@@ -386,6 +389,19 @@ void JsonAPI::handleSysInfoCommand(const QJsonObject&, const QString& command, c
 	emit callbackMessage(result);
 }
 
+void JsonAPI::handleMetricsCommand(const QJsonObject& message, const QString& command, const int tan)
+{
+	const QJsonObject metrics = LatencyTracer::getMetrics();
+
+	// a reset starts the next measurement period
+	if (message["reset"].toBool(false))
+	{
+		LatencyTracer::reset();
+	}
+
+	sendSuccessDataReply(QJsonDocument(metrics), command, tan);
+}
+
 void JsonAPI::handleServerInfoCommand(const QJsonObject& message, const QString& command, const int tan)
 {
 	QJsonObject info;
@@ -533,6 +549,23 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject& message, const QString&
 
 	info["effects"] = effects;
 
+	// collect running effects, frames produced but not consumed were replaced by newer ones
+	QJsonArray activeEffects;
+	for (const ActiveEffectDefinition & activeEffectDefinition : _hyperion->getActiveEffects())
+	{
+		QJsonObject activeEffect;
+		activeEffect["script"] = activeEffectDefinition.script;
+		activeEffect["name"] = activeEffectDefinition.name;
+		activeEffect["priority"] = activeEffectDefinition.priority;
+		activeEffect["timeout"] = activeEffectDefinition.timeout;
+		activeEffect["args"] = activeEffectDefinition.args;
+		activeEffect["framesProduced"] = double(activeEffectDefinition.framesProduced);
+		activeEffect["framesConsumed"] = double(activeEffectDefinition.framesConsumed);
+		activeEffects.append(activeEffect);
+	}
+
+	info["activeEffects"] = activeEffects;
+
 	// get available led devices
 	QJsonObject ledDevices;
 	ledDevices["active"] = _hyperion->getActiveDevice();
@@ -559,6 +592,11 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject& message, const QString&
 	info["videomode"] = QString(videoMode2String(_hyperion->getCurrentVideoMode()));
 	info["grabbers"]      = grabbers;
 
+	// bandwidth and cpu time of the forwarding targets
+	QJsonObject forwarder;
+	forwarder["proto"] = _hyperion->getForwarder()->getProtoStatistics();
+	info["forwarder"] = forwarder;
+
 	// get available components
 	QJsonArray component;
 	std::map<hyperion::Components, bool> components = _hyperion->getComponentRegister().getRegister();
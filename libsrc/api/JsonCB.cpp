@@ -182,7 +182,7 @@ void JsonCB::handlePriorityUpdate()
 	int currentPriority = _prioMuxer->getCurrentPriority();
 
 	foreach (int priority, activePriorities) {
-		const Hyperion::InputInfo priorityInfo = _prioMuxer->getInputInfo(priority);
+		const Hyperion::InputInfo& priorityInfo = _prioMuxer->getInputInfo(priority);
 		QJsonObject item;
 		item["priority"] = priority;
 		if (int(priorityInfo.timeoutTime_ms - now) > -1 )
@@ -21,10 +21,13 @@
 
 // project includes
 #include "BoblightClientConnection.h"
+#include "BoblightParser.h"
+
+/// Maximum number of tokens of a known boblight message
+const int BOBLIGHT_MAX_TOKENS = 8;
 
 BoblightClientConnection::BoblightClientConnection(Hyperion* hyperion, QTcpSocket *socket, const int priority)
 	: QObject()
-	, _locale(QLocale::C)
 	, _socket(socket)
 	, _imageProcessor(hyperion->getImageProcessor())
 	, _hyperion(hyperion)
@@ -34,9 +37,6 @@ BoblightClientConnection::BoblightClientConnection(Hyperion* hyperion, QTcpSocke
 	, _log(Logger::getInstance("BOBLIGHT"))
 	, _clientAddress(QHostInfo::fromName(socket->peerAddress().toString()).hostName())
 {
-	// initalize the locale. Start with the default C-locale
-	_locale.setNumberOptions(QLocale::OmitGroupSeparator | QLocale::RejectGroupSeparator);
-
 	// connect internal signals and slots
 	connect(_socket, SIGNAL(disconnected()), this, SLOT(socketClosed()));
 	connect(_socket, SIGNAL(readyRead()), this, SLOT(readData()));
@@ -58,26 +58,22 @@ void BoblightClientConnection::readData()
 {
 	_receiveBuffer += _socket->readAll();
 
-	int bytes = _receiveBuffer.indexOf('\n') + 1;
-	while(bytes > 0)
+	// handle the complete lines in place, the rest is kept for the next read
+	const char* data = _receiveBuffer.constData();
+	int begin = 0;
+	int newline;
+	while ((newline = _receiveBuffer.indexOf('\n', begin)) >= 0)
 	{
-		// create message string (strip the newline)
-		QString message = QString::fromLatin1(_receiveBuffer.data(), bytes-1);
-		// remove message data from buffer
-		_receiveBuffer = _receiveBuffer.mid(bytes);
-
-		// handle trimmed message
-		handleMessage(message.trimmed());
-
-		// drop messages if the buffer is too full
-		if (_receiveBuffer.size() > 100*1024)
-		{
-			Debug(_log, "server drops messages (buffer full)");
-			_receiveBuffer.clear();
-		}
+		handleMessage(data + begin, newline - begin);
+		begin = newline + 1;
+	}
+	_receiveBuffer.remove(0, begin);
 
-		// try too look up '\n' again
-		bytes = _receiveBuffer.indexOf('\n') + 1;
+	// drop messages if the buffer is too full
+	if (_receiveBuffer.size() > 100*1024)
+	{
+		Debug(_log, "server drops messages (buffer full)");
+		_receiveBuffer.clear();
 	}
 }
 
@@ -93,13 +89,13 @@ void BoblightClientConnection::socketClosed()
 	emit connectionClosed(this);
 }
 
-void BoblightClientConnection::handleMessage(const QString & message)
+void BoblightClientConnection::handleMessage(const char* message, int size)
 {
-	//std::cout << "boblight message: " << message.toStdString() << std::endl;
+	BoblightParser parser(message, size);
+	BoblightParser::Token messageParts[BOBLIGHT_MAX_TOKENS];
+	const int partCount = parser.split(messageParts, BOBLIGHT_MAX_TOKENS);
 
-	QStringList messageParts = message.split(" ", QString::SkipEmptyParts);
-
-	if (messageParts.size() > 0)
+	if (partCount > 0 && partCount <= BOBLIGHT_MAX_TOKENS)
 	{
 		if (messageParts[0] == "hello")
 		{
@@ -111,7 +107,7 @@ void BoblightClientConnection::handleMessage(const QString & message)
 			sendMessage("ping 1\n");
 			return;
 		}
-		else if (messageParts[0] == "get" && messageParts.size() > 1)
+		else if (messageParts[0] == "get" && partCount > 1)
 		{
 			if (messageParts[1] == "version")
 			{
@@ -124,44 +120,25 @@ void BoblightClientConnection::handleMessage(const QString & message)
 				return;
 			}
 		}
-		else if (messageParts[0] == "set" && messageParts.size() > 2)
+		else if (messageParts[0] == "set" && partCount > 2)
 		{
-			if (messageParts.size() > 3 && messageParts[1] == "light")
+			if (partCount > 3 && messageParts[1] == "light")
 			{
-				bool rc;
-				unsigned ledIndex = messageParts[2].toUInt(&rc);
-				if (rc && ledIndex < _ledColors.size())
+				unsigned ledIndex;
+				if (BoblightParser::parseUInt(messageParts[2], ledIndex) && ledIndex < _ledColors.size())
 				{
-					if (messageParts[3] == "rgb" && messageParts.size() == 7)
+					if (messageParts[3] == "rgb" && partCount == 7)
 					{
-						// replace decimal comma with decimal point
-						messageParts[4].replace(',', '.');
-						messageParts[5].replace(',', '.');
-						messageParts[6].replace(',', '.');
-
-						bool rc1, rc2, rc3;
-						uint8_t red = qMax(0, qMin(255, int(255 * messageParts[4].toFloat(&rc1))));
-
-						// check for correct locale should not be needed anymore - please check!
-						if (!rc1)
-						{
-							// maybe a locale issue. switch to a locale with a comma instead of a dot as decimal seperator (or vice versa)
-							_locale = QLocale((_locale.decimalPoint() == QChar('.')) ? QLocale::Dutch : QLocale::C);
-							_locale.setNumberOptions(QLocale::OmitGroupSeparator | QLocale::RejectGroupSeparator);
-
-							// try again
-							red = qMax(0, qMin(255, int(255 * messageParts[4].toFloat(&rc1))));
-						}
-
-						uint8_t green = qMax(0, qMin(255, int(255 * messageParts[5].toFloat(&rc2))));
-						uint8_t blue  = qMax(0, qMin(255, int(255 * messageParts[6].toFloat(&rc3))));
-
-						if (rc1 && rc2 && rc3)
+						// decimal points and decimal commas are accepted
+						float red, green, blue;
+						if (BoblightParser::parseFloat(messageParts[4], red)
+							&& BoblightParser::parseFloat(messageParts[5], green)
+							&& BoblightParser::parseFloat(messageParts[6], blue))
 						{
 							ColorRgb & rgb =  _ledColors[ledIndex];
-							rgb.red = red;
-							rgb.green = green;
-							rgb.blue = blue;
+							rgb.red   = uint8_t(255 * qBound(0.0f, red, 1.0f));
+							rgb.green = uint8_t(255 * qBound(0.0f, green, 1.0f));
+							rgb.blue  = uint8_t(255 * qBound(0.0f, blue, 1.0f));
 
 							// send current color values to hyperion if this is the last led assuming leds values are send in order of id
 							if ((ledIndex == _ledColors.size() -1) && _priority < 255)
@@ -182,11 +159,10 @@ void BoblightClientConnection::handleMessage(const QString & message)
 					}
 				}
 			}
-			else if (messageParts.size() == 3 && messageParts[1] == "priority")
+			else if (partCount == 3 && messageParts[1] == "priority")
 			{
-				bool rc;
-				int prio = messageParts[2].toInt(&rc);
-				if (rc && prio != _priority)
+				int prio;
+				if (BoblightParser::parseInt(messageParts[2], prio) && prio != _priority)
 				{
 					if (_priority < 255)
 					{
@@ -210,7 +186,7 @@ void BoblightClientConnection::handleMessage(const QString & message)
 		}
 	}
 
-	Debug(_log, "unknown boblight message: %s", QSTRING_CSTR(message));
+	Debug(_log, "unknown boblight message: %s", QByteArray(message, size).trimmed().constData());
 }
 
 void BoblightClientConnection::sendMessage(const QByteArray & message)
@@ -3,7 +3,6 @@
 // Qt includes
 #include <QByteArray>
 #include <QTcpSocket>
-#include <QLocale>
 
 // Hyperion includes
 #include <utils/Logger.h>
@@ -54,9 +53,10 @@ private:
 	///
 	/// Handle an incoming boblight message
 	///
-	/// @param message the incoming message as string
+	/// @param message the incoming message without the newline, it isn't copied
+	/// @param size the size of the message
 	///
-	void handleMessage(const QString &message);
+	void handleMessage(const char* message, int size);
 
 	///
 	/// Send a message to the connected client
@@ -71,9 +71,6 @@ private:
 	void sendLightMessage();
 
 private:
-	/// Locale used for parsing floating point values
-	QLocale _locale;
-
 	/// The TCP-Socket that is connected tot the boblight-client
 	QTcpSocket * _socket;
 
@@ -0,0 +1,178 @@
+// STL includes
+#include <cmath>
+#include <cstdint>
+
+// project includes
+#include "BoblightParser.h"
+
+namespace {
+
+	inline bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	inline bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	/// Exact powers of ten of a double
+	const double POW10[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	inline double pow10(int exponent)
+	{
+		return (exponent <= 22) ? POW10[exponent] : std::pow(10.0, exponent);
+	}
+
+	/// Limit of the mantissa, further digits only shift the exponent
+	const uint64_t MANTISSA_LIMIT = UINT64_C(100000000000000000);
+}
+
+BoblightParser::BoblightParser(const char* data, int size)
+	: _data(data)
+	, _size(size)
+{
+}
+
+int BoblightParser::split(Token* tokens, int maxTokens)
+{
+	int count = 0;
+	const char* it = _data;
+	const char* end = _data + _size;
+
+	while (true)
+	{
+		while (it != end && isSpace(*it))
+			++it;
+
+		if (it == end)
+			return count;
+
+		const char* begin = it;
+		while (it != end && !isSpace(*it))
+			++it;
+
+		if (count < maxTokens)
+		{
+			tokens[count].data = begin;
+			tokens[count].size = int(it - begin);
+		}
+		++count;
+	}
+}
+
+bool BoblightParser::parseUInt(const Token& token, unsigned& value)
+{
+	if (token.size == 0)
+		return false;
+
+	uint64_t result = 0;
+	for (int i = 0; i < token.size; ++i)
+	{
+		if (!isDigit(token.data[i]))
+			return false;
+
+		result = result * 10 + unsigned(token.data[i] - '0');
+		if (result > 0xFFFFFFFFu)
+			return false;
+	}
+	value = unsigned(result);
+	return true;
+}
+
+bool BoblightParser::parseInt(const Token& token, int& value)
+{
+	Token digits = token;
+	bool negative = false;
+	if (digits.size > 0 && (digits.data[0] == '-' || digits.data[0] == '+'))
+	{
+		negative = digits.data[0] == '-';
+		++digits.data;
+		--digits.size;
+	}
+
+	unsigned result;
+	if (!parseUInt(digits, result) || result > (negative ? 2147483648u : 2147483647u))
+		return false;
+
+	value = negative ? int(-int64_t(result)) : int(result);
+	return true;
+}
+
+bool BoblightParser::parseFloat(const Token& token, float& value)
+{
+	const char* it = token.data;
+	const char* end = token.data + token.size;
+
+	bool negative = false;
+	if (it != end && (*it == '-' || *it == '+'))
+	{
+		negative = *it == '-';
+		++it;
+	}
+
+	// the digits as integer mantissa and a decimal exponent
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	for (; it != end && isDigit(*it); ++it, ++digits)
+	{
+		if (mantissa < MANTISSA_LIMIT)
+			mantissa = mantissa * 10 + unsigned(*it - '0');
+		else
+			++exponent;
+	}
+
+	// decimal point or decimal comma
+	if (it != end && (*it == '.' || *it == ','))
+	{
+		for (++it; it != end && isDigit(*it); ++it, ++digits)
+		{
+			if (mantissa < MANTISSA_LIMIT)
+			{
+				mantissa = mantissa * 10 + unsigned(*it - '0');
+				--exponent;
+			}
+		}
+	}
+
+	if (digits == 0)
+		return false;
+
+	if (it != end && (*it == 'e' || *it == 'E'))
+	{
+		++it;
+		bool negativeExponent = false;
+		if (it != end && (*it == '-' || *it == '+'))
+		{
+			negativeExponent = *it == '-';
+			++it;
+		}
+
+		if (it == end)
+			return false;
+
+		int exponentValue = 0;
+		for (; it != end && isDigit(*it); ++it)
+		{
+			if (exponentValue < 1000)
+				exponentValue = exponentValue * 10 + (*it - '0');
+		}
+		exponent += negativeExponent ? -exponentValue : exponentValue;
+	}
+
+	if (it != end)
+		return false;
+
+	// the division by an exact power of ten rounds like a conversion of the decimal string
+	double result = double(mantissa);
+	if (mantissa != 0)
+		result = (exponent < 0) ? result / pow10(-exponent) : result * pow10(exponent);
+
+	value = float(negative ? -result : result);
+	return true;
+}
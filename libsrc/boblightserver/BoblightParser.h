@@ -0,0 +1,62 @@
+#pragma once
+
+// STL includes
+#include <cstring>
+
+///
+/// Allocation free tokenizer of a boblight message line. The tokens point into the line, which has to
+/// stay valid while they are used. Numbers are parsed without QString and locale conversions.
+///
+class BoblightParser
+{
+public:
+	/// A token of the line, not terminated
+	struct Token
+	{
+		const char* data;
+		int size;
+
+		/// @return true if the token equals the literal
+		bool operator==(const char* literal) const
+		{
+			return int(strlen(literal)) == size && memcmp(data, literal, size) == 0;
+		}
+		bool operator!=(const char* literal) const { return !(*this == literal); }
+	};
+
+	///
+	/// @param data  The line without the newline
+	/// @param size  The size of the line
+	///
+	BoblightParser(const char* data, int size);
+
+	///
+	/// @brief Split the line at spaces and tabs, empty tokens are skipped
+	/// @param[out] tokens     Receives the tokens
+	/// @param      maxTokens  The capacity of tokens, further tokens are counted only
+	/// @return The number of tokens of the line
+	///
+	int split(Token* tokens, int maxTokens);
+
+	///
+	/// @brief Parse an unsigned decimal integer
+	/// @return true if the whole token is a number
+	///
+	static bool parseUInt(const Token& token, unsigned& value);
+
+	///
+	/// @brief Parse a decimal integer with an optional sign
+	/// @return true if the whole token is a number
+	///
+	static bool parseInt(const Token& token, int& value);
+
+	///
+	/// @brief Parse a floating point number like "0.25", "-1", "1e-3" or "0,25" of clients with a comma locale
+	/// @return true if the whole token is a number
+	///
+	static bool parseFloat(const Token& token, float& value);
+
+private:
+	const char* _data;
+	const int _size;
+};
@@ -17,7 +17,10 @@
 // effect engin eincludes
 #include <effectengine/Effect.h>
 #include <effectengine/EffectModule.h>
+#include <effectengine/NativeEffect.h>
+#include <effectengine/EffectInterpreterPool.h>
 #include <utils/Logger.h>
+#include <utils/MetricsRegistry.h>
 #include <hyperion/Hyperion.h>
 
 // python utils/ global mainthread
@@ -26,8 +29,16 @@
 PyThreadState* mainThreadState;
 
 Effect::Effect(Hyperion* hyperion, int priority, int timeout, const QString & script, const QString & name, const QJsonObject & args)
+	: Effect(hyperion->getLedCount(), hyperion->getLatchTime(), hyperion->getLedGridSize(), priority, timeout, script, name, args)
+{
+	_hyperion = hyperion;
+}
+
+Effect::Effect(int ledCount, int latchTime, const QSize & ledGridSize, int priority, int timeout, const QString & script, const QString & name, const QJsonObject & args)
 	: QThread()
-	, _hyperion(hyperion)
+	, _simulatedClock(false)
+	, _hyperion(nullptr)
+	, _latchTime(latchTime)
 	, _priority(priority)
 	, _timeout(timeout)
 	, _script(script)
@@ -35,10 +46,16 @@ Effect::Effect(Hyperion* hyperion, int priority, int timeout, const QString & sc
 	, _args(args)
 	, _endTime(-1)
 	, _colors()
-	, _imageSize(hyperion->getLedGridSize())
+	, _imageSize(ledGridSize)
 	, _image(_imageSize,QImage::Format_ARGB32_Premultiplied)
+	, _outputPending(false)
+	, _outputIsImage(false)
+	, _outputTimeout(-1)
+	, _framesProduced(0)
+	, _framesConsumed(0)
+	, _cpuTime(0)
 {
-	_colors.resize(_hyperion->getLedCount());
+	_colors.resize(ledCount);
 	_colors.fill(ColorRgb::BLACK);
 
 	_log = Logger::getInstance("EFFECTENGINE");
@@ -56,20 +73,189 @@ Effect::~Effect()
 	_imageStack.clear();
 }
 
+void Effect::runNative()
+{
+	NativeEffect* effect = NativeEffect::create(_script);
+	if (effect == nullptr)
+	{
+		Error(_log, "Native effect %s not found", QSTRING_CSTR(_script));
+		return;
+	}
+
+	effect->setup(_args, _colors.size(), _latchTime, _imageSize);
+
+	while (!_interupt)
+	{
+		// determine the timeout, the effect ends like a python effect which checked abort()
+		int timeout = _timeout;
+		if (timeout > 0)
+		{
+			timeout = _endTime - currentTime();
+			if (timeout <= 0)
+			{
+				setInteruptionFlag();
+				break;
+			}
+		}
+
+		const int sleepTime = effect->render();
+		if (sleepTime < 0)
+		{
+			break;
+		}
+
+		if (effect->hasImageOutput())
+			setOutputImage(effect->image(), timeout);
+		else
+			setOutput(effect->colors(), timeout);
+
+		waitFor(sleepTime);
+	}
+
+	delete effect;
+}
+
+qint64 Effect::currentTime()
+{
+	return QDateTime::currentMSecsSinceEpoch();
+}
+
+void Effect::waitFor(int ms)
+{
+	// sleep in slices to react on interruptions
+	for (int remaining = ms; remaining > 0 && !_interupt; remaining -= 50)
+	{
+		msleep(qMin(remaining, 50));
+	}
+}
+
+void Effect::writeOutput(const std::vector<ColorRgb>& ledColors, const int timeout_ms)
+{
+	_hyperion->setInput(_priority, ledColors, timeout_ms, false);
+}
+
+void Effect::writeOutputImage(const Image<ColorRgb>& image, const int timeout_ms)
+{
+	_hyperion->setInputImage(_priority, image, timeout_ms, false);
+}
+
+void Effect::setOutput(const QVector<ColorRgb>& ledColors, const int timeout_ms)
+{
+	QMutexLocker lock(&_outputMutex);
+	_outputColors.assign(ledColors.constBegin(), ledColors.constEnd());
+	_outputIsImage = false;
+	_outputTimeout = timeout_ms;
+	outputProduced();
+}
+
+void Effect::setOutputImage(const Image<ColorRgb>& image, const int timeout_ms)
+{
+	QMutexLocker lock(&_outputMutex);
+	_outputImage.resize(image.width(), image.height());
+	_outputImage.copy(image);
+	_outputIsImage = true;
+	_outputTimeout = timeout_ms;
+	outputProduced();
+}
+
+void Effect::setOutputImage(const QImage& qimage, const int timeout_ms)
+{
+	QMutexLocker lock(&_outputMutex);
+	_outputImage.resize(qimage.width(), qimage.height());
+	EffectModule::qimage2rgb(qimage, reinterpret_cast<uint8_t*>(_outputImage.memptr()));
+	_outputIsImage = true;
+	_outputTimeout = timeout_ms;
+	outputProduced();
+}
+
+void Effect::outputProduced()
+{
+	++_framesProduced;
+
+	// the CPU time of the effect thread is accounted with each frame
+	const int64_t cpuTime = MetricsRegistry::threadCpuTime();
+	MetricsRegistry::add(MetricsRegistry::EFFECT_CPU_NS, uint64_t(qMax(cpuTime - _cpuTime, int64_t(0))));
+	_cpuTime = cpuTime;
+
+	// the main thread picks up the latest output with the pending notification
+	if (!_outputPending)
+	{
+		_outputPending = true;
+		emit outputAvailable();
+	}
+	else
+	{
+		// the previous output has not been picked up and is replaced
+		MetricsRegistry::add(MetricsRegistry::DROPPED_EFFECT);
+	}
+}
+
+void Effect::forwardOutput()
+{
+	bool isImage;
+	int timeout;
+	{
+		QMutexLocker lock(&_outputMutex);
+		if (!_outputPending)
+			return;
+
+		// swap the buffers, so the effect thread continues with the forwarded ones
+		isImage = _outputIsImage;
+		timeout = _outputTimeout;
+		if (isImage)
+			_forwardImage.swap(_outputImage);
+		else
+			_forwardColors.swap(_outputColors);
+
+		_outputPending = false;
+		++_framesConsumed;
+	}
+
+	// outputs of a cleared channel are dropped
+	if (_interupt)
+		return;
+
+	if (isImage)
+		writeOutputImage(_forwardImage, timeout);
+	else
+		writeOutput(_forwardColors, timeout);
+}
+
+void Effect::getFrameCounters(quint64& produced, quint64& consumed)
+{
+	QMutexLocker lock(&_outputMutex);
+	produced = _framesProduced;
+	consumed = _framesConsumed;
+}
+
 void Effect::run()
 {
+	_cpuTime = MetricsRegistry::threadCpuTime();
+
+	// Set the end time if applicable
+	if (_timeout > 0)
+	{
+		_endTime = currentTime() + _timeout;
+	}
+
+	// native effects run without python
+	if (NativeEffect::isNative(_script))
+	{
+		runNative();
+		return;
+	}
+
 	// get global lock
 	PyEval_RestoreThread(mainThreadState);
 
-	// Initialize a new thread state
-	PyThreadState* tstate = Py_NewInterpreter();
+	// Get a warm interpreter, the thread state is the current one
+	PyThreadState* tstate = EffectInterpreterPool::getInstance()->acquire();
 	if(tstate == nullptr)
 	{
 		PyEval_ReleaseLock();
 		Error(_log, "Failed to get thread state for %s",QSTRING_CSTR(_name));
 		return;
 	}
-	PyThreadState_Swap(tstate);
 
 	// import the buildtin Hyperion module
 	PyObject * module = PyImport_ImportModule("hyperion");
@@ -78,10 +264,10 @@ void Effect::run()
 	PyObject_SetAttrString(module, "__effectObj", PyCapsule_New(this, nullptr, nullptr));
 
 	// add ledCount variable to the interpreter
-	PyObject_SetAttrString(module, "ledCount", Py_BuildValue("i", _hyperion->getLedCount()));
+	PyObject_SetAttrString(module, "ledCount", Py_BuildValue("i", _colors.size()));
 
 	// add minimumWriteTime variable to the interpreter
-	PyObject_SetAttrString(module, "latchTime", Py_BuildValue("i", _hyperion->getLatchTime()));
+	PyObject_SetAttrString(module, "latchTime", Py_BuildValue("i", _latchTime));
 
 	// add a args variable to the interpreter
 	PyObject_SetAttrString(module, "args", EffectModule::json2python(_args));
@@ -89,35 +275,35 @@ void Effect::run()
 	// decref the module
 	Py_XDECREF(module);
 
-	// Set the end time if applicable
-	if (_timeout > 0)
+	// the replaced time functions must not leak into other effects, so the interpreter is not reused
+	bool reusable = true;
+	if (_simulatedClock)
 	{
-		_endTime = QDateTime::currentMSecsSinceEpoch() + _timeout;
+		EffectModule::simulateClock();
+		reusable = false;
 	}
 
-	// Run the effect script
-	QFile file (_script);
-	QByteArray python_code;
-	if (file.open(QIODevice::ReadOnly))
+	// Run the effect script, compiled once per script
+	QString error;
+	PyObject *code = EffectInterpreterPool::getInstance()->getCode(_script, error); // New Reference
+	if (code == nullptr && !error.isEmpty())
 	{
-		python_code = file.readAll();
+		Error(_log, "%s", QSTRING_CSTR(error));
 	}
 	else
-	{
-		Error(_log, "Unable to open script file %s.", QSTRING_CSTR(_script));
-	}
-	file.close();
-
-	if (!python_code.isEmpty())
 	{
 		PyObject *main_module = PyImport_ImportModule("__main__"); // New Reference
 		PyObject *main_dict = PyModule_GetDict(main_module); // Borrowed reference
-		Py_INCREF(main_dict); // Incref "main_dict" to use it in PyRun_String(), because PyModule_GetDict() has decref "main_dict"
+		Py_INCREF(main_dict); // Incref "main_dict" to use it in PyEval_EvalCode(), because PyModule_GetDict() has decref "main_dict"
 		Py_DECREF(main_module); // // release "main_module" when done
-		PyObject *result = PyRun_String(python_code.constData(), Py_file_input, main_dict, main_dict); // New Reference
+		PyObject *result = (code != nullptr) ? PyEval_EvalCode(code, main_dict, main_dict) : nullptr; // New Reference
+		Py_XDECREF(code);
 
 		if (!result)
 		{
+			// the script might have left the interpreter in any state
+			reusable = false;
+
 			if (PyErr_Occurred()) // Nothing needs to be done for a borrowed reference
 			{
 				Error(_log,"###### PYTHON EXCEPTION ######");
@@ -229,7 +415,7 @@ void Effect::run()
 		s = tstate->interp->tstate_head;
 	}
 
-	// Clean up the thread state
-	Py_EndInterpreter(tstate);
+	// Clean up the thread state, keep the interpreter for the next effect
+	EffectInterpreterPool::getInstance()->release(tstate, reusable);
 	PyEval_ReleaseLock();
 }
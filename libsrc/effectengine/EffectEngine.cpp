@@ -18,6 +18,9 @@
 #include <effectengine/EffectEngine.h>
 #include <effectengine/Effect.h>
 #include <effectengine/EffectModule.h>
+#include <effectengine/EffectImageCache.h>
+#include <effectengine/NativeEffect.h>
+#include <effectengine/EffectInterpreterPool.h>
 #include "HyperionConfig.h"
 
 EffectEngine::EffectEngine(Hyperion * hyperion, const QJsonObject & jsonEffectConfig)
@@ -35,6 +38,13 @@ EffectEngine::EffectEngine(Hyperion * hyperion, const QJsonObject & jsonEffectCo
 	// connect the Hyperion channel clear feedback
 	connect(_hyperion, SIGNAL(channelCleared(int)), this, SLOT(channelCleared(int)));
 	connect(_hyperion, SIGNAL(allChannelsCleared()), this, SLOT(allChannelsCleared()));
+	connect(_hyperion, &Hyperion::settingsChanged, this, &EffectEngine::handleSettingsUpdate);
+
+	// memory budget of decoded effect images
+	EffectImageCache::getInstance()->setMaxSize(_effectConfig["imageCacheSize"].toInt(64) * 1024);
+
+	// prepare interpreters for fast effect starts
+	EffectInterpreterPool::getInstance()->warmUp();
 
 	// read all effects
 	readEffects();
@@ -44,6 +54,20 @@ EffectEngine::~EffectEngine()
 {
 }
 
+void EffectEngine::handleSettingsUpdate(const settings::type& type, const QJsonDocument& config)
+{
+	if (type == settings::EFFECTS)
+	{
+		_effectConfig = config.object();
+
+		// a smaller budget evicts the least recently used images right away
+		EffectImageCache::getInstance()->setMaxSize(_effectConfig["imageCacheSize"].toInt(64) * 1024);
+
+		// paths and disabled effects
+		readEffects();
+	}
+}
+
 const std::list<ActiveEffectDefinition> &EffectEngine::getActiveEffects()
 {
 	_availableActiveEffects.clear();
@@ -56,6 +80,7 @@ const std::list<ActiveEffectDefinition> &EffectEngine::getActiveEffects()
 		activeEffectDefinition.priority = effect->getPriority();
 		activeEffectDefinition.timeout  = effect->getTimeout();
 		activeEffectDefinition.args     = effect->getArgs();
+		effect->getFrameCounters(activeEffectDefinition.framesProduced, activeEffectDefinition.framesConsumed);
 		_availableActiveEffects.push_back(activeEffectDefinition);
 	}
 
@@ -89,18 +114,18 @@ void EffectEngine::startCachedEffects()
 	_cachedActiveEffects.clear();
 }
 
-bool EffectEngine::loadEffectDefinition(const QString &path, const QString &effectConfigFile, EffectDefinition & effectDefinition)
+bool EffectEngine::readEffectDefinition(const QString &path, const QString &effectConfigFile, EffectDefinition & effectDefinition, Logger * log)
 {
 	QString fileName = path + QDir::separator() + effectConfigFile;
 
 	// Read and parse the effect json config file
 	QJsonObject configEffect;
-	if(!JsonUtils::readFile(fileName, configEffect, _log))
+	if(!JsonUtils::readFile(fileName, configEffect, log))
 		return false;
 
 	Q_INIT_RESOURCE(EffectEngine);
 	// validate effect config with effect schema(path)
-	if(!JsonUtils::validate(fileName, configEffect, ":effect-schema", _log))
+	if(!JsonUtils::validate(fileName, configEffect, ":effect-schema", log))
 		return false;
 
 	// setup the definition
@@ -113,7 +138,16 @@ bool EffectEngine::loadEffectDefinition(const QString &path, const QString &effe
 
 	QFile fileInfo(scriptName);
 
-	if (scriptName.mid(0, 1)  == ":" )
+	if (scriptName.startsWith(NATIVE_EFFECT_PREFIX))
+	{
+		if (!NativeEffect::isNative(scriptName))
+		{
+			Error(log, "Native effect '%s' of '%s' is not available", QSTRING_CSTR(scriptName), QSTRING_CSTR(fileName));
+			return false;
+		}
+		effectDefinition.script = scriptName;
+	}
+	else if (scriptName.mid(0, 1)  == ":" )
 	{
 		(!fileInfo.exists())
 		? effectDefinition.script = ":/effects/"+scriptName.mid(1)
@@ -127,6 +161,14 @@ bool EffectEngine::loadEffectDefinition(const QString &path, const QString &effe
 
 	effectDefinition.args = config["args"].toObject();
 	effectDefinition.smoothCfg = SMOOTHING_MODE_PAUSE;
+	return true;
+}
+
+bool EffectEngine::loadEffectDefinition(const QString &path, const QString &effectConfigFile, EffectDefinition & effectDefinition)
+{
+	if (!readEffectDefinition(path, effectConfigFile, effectDefinition, _log))
+		return false;
+
 	if (effectDefinition.args["smoothing-custom-settings"].toBool())
 	{
 		effectDefinition.smoothCfg = _hyperion->addSmoothingConfig(
@@ -299,9 +341,8 @@ int EffectEngine::runEffectScript(const QString &script, const QString &name, co
 	channelCleared(priority);
 
 	// create the effect
-    Effect * effect = new Effect(_hyperion, priority, timeout, script, name, args);
-	connect(effect, &Effect::setInput, _hyperion, &Hyperion::setInput, Qt::QueuedConnection);
-	connect(effect, &Effect::setInputImage, _hyperion, &Hyperion::setInputImage, Qt::QueuedConnection);
+	Effect * effect = new Effect(_hyperion, priority, timeout, script, name, args);
+	connect(effect, &Effect::outputAvailable, this, &EffectEngine::effectOutputAvailable, Qt::QueuedConnection);
 	connect(effect, &QThread::finished, this, &EffectEngine::effectFinished);
 	_activeEffects.push_back(effect);
 
@@ -356,3 +397,12 @@ void EffectEngine::effectFinished()
 	// cleanup the effect
 	effect->deleteLater();
 }
+
+void EffectEngine::effectOutputAvailable()
+{
+	Effect* effect = qobject_cast<Effect*>(sender());
+	if (effect != nullptr)
+	{
+		effect->forwardOutput();
+	}
+}
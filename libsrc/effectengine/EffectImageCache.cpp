@@ -0,0 +1,103 @@
+// Qt includes
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImage>
+#include <QMutexLocker>
+
+// effect engine includes
+#include <effectengine/EffectImageCache.h>
+#include <effectengine/EffectModule.h>
+
+EffectImageCache* EffectImageCache::getInstance()
+{
+	static EffectImageCache instance;
+	return &instance;
+}
+
+EffectImageCache::EffectImageCache()
+	: _mutex()
+	, _cache(EFFECT_IMAGE_CACHE_SIZE)
+{
+}
+
+bool EffectImageCache::getFrames(const QString& file, EffectImageFrames& frames, QString& error)
+{
+	const QDateTime lastModified = QFileInfo(file).lastModified();
+
+	{
+		QMutexLocker lock(&_mutex);
+		Entry* entry = _cache.object(file);
+		if (entry != nullptr && entry->lastModified == lastModified)
+		{
+			frames = entry->frames;
+			return true;
+		}
+	}
+
+	// decode without holding the lock, other effects keep on using the cache
+	if (!decode(file, frames, error))
+	{
+		return false;
+	}
+
+	int cost = 0;
+	for (const EffectImageFrame& frame : frames)
+	{
+		cost += frame.data.size() / 1024 + 1;
+	}
+
+	QMutexLocker lock(&_mutex);
+	// images exceeding the whole budget are deleted by insert and just not cached
+	_cache.insert(file, new Entry{lastModified, frames}, cost);
+	return true;
+}
+
+void EffectImageCache::setMaxSize(int kibibytes)
+{
+	QMutexLocker lock(&_mutex);
+	_cache.setMaxCost(kibibytes);
+}
+
+void EffectImageCache::clear()
+{
+	QMutexLocker lock(&_mutex);
+	_cache.clear();
+}
+
+bool EffectImageCache::decode(const QString& file, EffectImageFrames& frames, QString& error)
+{
+	QImageReader reader(file);
+	if (!reader.canRead())
+	{
+		error = reader.errorString();
+		return false;
+	}
+
+	frames.clear();
+	frames.reserve(reader.imageCount());
+	for (int i = 0; i < reader.imageCount(); ++i)
+	{
+		reader.jumpToImage(i);
+		if (!reader.canRead())
+		{
+			error = reader.errorString();
+			return false;
+		}
+
+		QImage qimage = reader.read();
+
+		// gif frames might be indexed
+		if (qimage.depth() != 32)
+		{
+			qimage = qimage.convertToFormat(QImage::Format_RGB32);
+		}
+
+		EffectImageFrame frame;
+		frame.width = qimage.width();
+		frame.height = qimage.height();
+		frame.data.resize(3 * frame.width * frame.height);
+		EffectModule::qimage2rgb(qimage, reinterpret_cast<uint8_t*>(frame.data.data()));
+		frames.append(frame);
+	}
+	return true;
+}
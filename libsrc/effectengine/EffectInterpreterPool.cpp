@@ -0,0 +1,198 @@
+// effect engine includes
+#include <effectengine/EffectInterpreterPool.h>
+
+// Python includes
+#include <marshal.h>
+
+// Qt includes
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+// python utils/ global mainthread
+#include <python/PythonUtils.h>
+
+/// modules most effects import, loaded once per interpreter
+static const char* const PRELOADED_MODULES[] = { "hyperion", "time", "math", "colorsys", "random" };
+
+EffectInterpreterPool* EffectInterpreterPool::getInstance()
+{
+	static EffectInterpreterPool instance;
+	return &instance;
+}
+
+EffectInterpreterPool::EffectInterpreterPool()
+	: _mutex()
+	, _pool()
+	, _mainDicts()
+	, _code()
+{
+}
+
+void EffectInterpreterPool::warmUp()
+{
+	PyEval_RestoreThread(mainThreadState);
+
+	for (;;)
+	{
+		{
+			QMutexLocker lock(&_mutex);
+			if (_pool.size() >= EFFECT_INTERPRETER_POOL_SIZE)
+				break;
+		}
+
+		PyThreadState* tstate = createInterpreter();
+		if (tstate == nullptr)
+			break;
+
+		// keep the interpreter, drop the thread state of the main thread
+		PyInterpreterState* state = tstate->interp;
+		PyThreadState_Clear(tstate);
+		PyThreadState_Swap(mainThreadState);
+		PyThreadState_Delete(tstate);
+
+		QMutexLocker lock(&_mutex);
+		_pool.append(Interpreter{state, _mainDicts.take(state)});
+	}
+
+	mainThreadState = PyEval_SaveThread();
+}
+
+PyThreadState* EffectInterpreterPool::acquire()
+{
+	Interpreter interpreter = { nullptr, nullptr };
+	{
+		QMutexLocker lock(&_mutex);
+		if (!_pool.isEmpty())
+		{
+			interpreter = _pool.takeFirst();
+			_mainDicts.insert(interpreter.state, interpreter.mainDict);
+		}
+	}
+
+	if (interpreter.state == nullptr)
+	{
+		return createInterpreter();
+	}
+
+	PyThreadState* tstate = PyThreadState_New(interpreter.state);
+	PyThreadState_Swap(tstate);
+	return tstate;
+}
+
+void EffectInterpreterPool::release(PyThreadState* tstate, bool reusable)
+{
+	PyInterpreterState* state = tstate->interp;
+	PyObject* mainDict;
+	bool pooled = false;
+	{
+		QMutexLocker lock(&_mutex);
+		mainDict = _mainDicts.take(state);
+		pooled = reusable && mainDict != nullptr && _pool.size() < EFFECT_INTERPRETER_POOL_SIZE;
+	}
+
+	if (!pooled)
+	{
+		Py_XDECREF(mainDict);
+		Py_EndInterpreter(tstate);
+		return;
+	}
+
+	// restore the globals of the script to those of a new interpreter
+	PyObject* mainModule = PyImport_AddModule("__main__"); // Borrowed reference
+	PyObject* globals = PyModule_GetDict(mainModule); // Borrowed reference
+	PyDict_Clear(globals);
+	PyDict_Update(globals, mainDict);
+	PyErr_Clear();
+
+	PyThreadState_Clear(tstate);
+	PyThreadState_Swap(nullptr);
+	PyThreadState_Delete(tstate);
+
+	QMutexLocker lock(&_mutex);
+	_pool.append(Interpreter{state, mainDict});
+}
+
+PyObject* EffectInterpreterPool::getCode(const QString& script, QString& error)
+{
+	const QDateTime lastModified = QFileInfo(script).lastModified();
+
+	QByteArray bytecode;
+	{
+		QMutexLocker lock(&_mutex);
+		auto it = _code.constFind(script);
+		if (it != _code.constEnd() && it->lastModified == lastModified)
+			bytecode = it->bytecode;
+	}
+
+	if (!bytecode.isEmpty())
+	{
+		return PyMarshal_ReadObjectFromString(bytecode.constData(), bytecode.size());
+	}
+
+	QFile file(script);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		error = QString("Unable to open script file %1.").arg(script);
+		return nullptr;
+	}
+	const QByteArray source = file.readAll();
+	file.close();
+
+	PyObject* code = Py_CompileString(source.constData(), script.toUtf8().constData(), Py_file_input); // New Reference
+	if (code == nullptr)
+		return nullptr;
+
+	// marshalled bytecode does not belong to an interpreter
+	PyObject* marshalled = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION); // New Reference
+	if (marshalled != nullptr)
+	{
+		QMutexLocker lock(&_mutex);
+		_code.insert(script, Code{lastModified, QByteArray(PyBytes_AS_STRING(marshalled), PyBytes_GET_SIZE(marshalled))});
+	}
+	Py_XDECREF(marshalled);
+	PyErr_Clear();
+
+	return code;
+}
+
+void EffectInterpreterPool::clear()
+{
+	QList<Interpreter> pool;
+	{
+		QMutexLocker lock(&_mutex);
+		pool.swap(_pool);
+		_code.clear();
+	}
+
+	for (const Interpreter& interpreter : pool)
+	{
+		PyThreadState* tstate = PyThreadState_New(interpreter.state);
+		PyThreadState_Swap(tstate);
+		Py_XDECREF(interpreter.mainDict);
+		Py_EndInterpreter(tstate);
+	}
+	PyThreadState_Swap(mainThreadState);
+}
+
+PyThreadState* EffectInterpreterPool::createInterpreter()
+{
+	PyThreadState* tstate = Py_NewInterpreter();
+	if (tstate == nullptr)
+		return nullptr;
+
+	for (const char* name : PRELOADED_MODULES)
+	{
+		PyObject* module = PyImport_ImportModule(name); // New Reference
+		Py_XDECREF(module);
+	}
+	PyErr_Clear();
+
+	// remember the untouched globals to reset them when the interpreter is released
+	PyObject* mainModule = PyImport_AddModule("__main__"); // Borrowed reference
+	PyObject* mainDict = PyDict_Copy(PyModule_GetDict(mainModule)); // New Reference
+
+	QMutexLocker lock(&_mutex);
+	_mainDicts.insert(tstate->interp, mainDict);
+	return tstate;
+}
@@ -1,15 +1,19 @@
 
 #include <effectengine/Effect.h>
 #include <effectengine/EffectModule.h>
+#include <effectengine/EffectImageCache.h>
+
+// stl
+#include <algorithm>
+#include <cmath>
 
 // hyperion
 #include <hyperion/Hyperion.h>
 #include <utils/Logger.h>
+#include <utils/ColorSys.h>
 
 // qt
 #include <QJsonArray>
-#include <QDateTime>
-#include <QImageReader>
 
 // create the hyperion module
 struct PyModuleDef EffectModule::moduleDef = {
@@ -112,9 +116,71 @@ PyMethodDef EffectModule::effectMethods[] = {
 	{"imageCOffset"          , EffectModule::wrapImageCOffset          , METH_VARARGS, "Add offset to the coordinate system"},
 	{"imageCShear"           , EffectModule::wrapImageCShear           , METH_VARARGS, "Shear of coordinate system by the given horizontal/vertical axis"},
 	{"imageResetT"           , EffectModule::wrapImageResetT           , METH_NOARGS,  "Resets all coords modifications (rotate,offset,shear)"},
+	{"ledFill"               , EffectModule::wrapLedFill               , METH_VARARGS, "fill a range of the led buffer with a color"},
+	{"ledHsvGradient"        , EffectModule::wrapLedHsvGradient        , METH_VARARGS, "fill a range of the led buffer with a hsv gradient"},
+	{"ledFade"               , EffectModule::wrapLedFade               , METH_VARARGS, "scale a range of the led buffer by a factor"},
+	{"ledRotate"             , EffectModule::wrapLedRotate             , METH_VARARGS, "rotate the led buffer by the given number of leds"},
+	{"ledShift"              , EffectModule::wrapLedShift              , METH_VARARGS, "shift the led buffer by the given number of leds"},
+	{"ledBlend"              , EffectModule::wrapLedBlend              , METH_VARARGS, "blend a bytearray into the led buffer"},
+	{"ledGet"                , EffectModule::wrapLedGet                , METH_NOARGS,  "get the led buffer as bytearray"},
+	{"ledShow"               , EffectModule::wrapLedShow               , METH_NOARGS,  "set the led buffer to hyperion core"},
+	{NULL, NULL, 0, NULL}
+};
+
+// Clock of the time module for effects with a simulated clock
+PyMethodDef EffectModule::clockMethods[] = {
+	{"time"                  , EffectModule::wrapClockTime             , METH_NOARGS,  "Simulated time in seconds since epoch."},
+	{"monotonic"             , EffectModule::wrapClockTime             , METH_NOARGS,  "Simulated time in seconds since epoch."},
+	{"perf_counter"          , EffectModule::wrapClockTime             , METH_NOARGS,  "Simulated time in seconds since epoch."},
+	{"sleep"                 , EffectModule::wrapClockSleep            , METH_VARARGS, "Advance the simulated time."},
 	{NULL, NULL, 0, NULL}
 };
 
+void EffectModule::simulateClock()
+{
+	// replace the clock functions of the time module of the current interpreter
+	PyObject * timeModule = PyImport_ImportModule("time");
+	if (timeModule != nullptr)
+	{
+		for (PyMethodDef * method = clockMethods; method->ml_name != nullptr; ++method)
+		{
+			PyObject * function = PyCFunction_New(method, nullptr);
+			PyObject_SetAttrString(timeModule, method->ml_name, function);
+			Py_XDECREF(function);
+		}
+		Py_DECREF(timeModule);
+	}
+
+	// random numbers are reproducible
+	PyObject * randomModule = PyImport_ImportModule("random");
+	if (randomModule != nullptr)
+	{
+		PyObject * result = PyObject_CallMethod(randomModule, "seed", "i", 0);
+		Py_XDECREF(result);
+		Py_DECREF(randomModule);
+	}
+	PyErr_Clear();
+}
+
+void EffectModule::qimage2rgb(const QImage & qimage, uint8_t * rgb)
+{
+	const int width = qimage.width();
+	const int height = qimage.height();
+
+	for (int y = 0; y < height; ++y)
+	{
+		const QRgb * pixel = reinterpret_cast<const QRgb *>(qimage.constScanLine(y));
+		const QRgb * end = pixel + width;
+		for (; pixel < end; ++pixel, rgb += 3)
+		{
+			const QRgb value = *pixel;
+			rgb[0] = uint8_t(value >> 16);
+			rgb[1] = uint8_t(value >> 8);
+			rgb[2] = uint8_t(value);
+		}
+	}
+}
+
 PyObject* EffectModule::wrapSetColor(PyObject *self, PyObject *args)
 {
 	// get the effect
@@ -130,7 +196,7 @@ PyObject* EffectModule::wrapSetColor(PyObject *self, PyObject *args)
 	int timeout = effect->_timeout;
 	if (timeout > 0)
 	{
-		timeout = effect->_endTime - QDateTime::currentMSecsSinceEpoch();
+		timeout = effect->_endTime - effect->currentTime();
 
 		// we are done if the time has passed
 		if (timeout <= 0)
@@ -148,7 +214,7 @@ PyObject* EffectModule::wrapSetColor(PyObject *self, PyObject *args)
 		if (PyArg_ParseTuple(args, "bbb", &color.red, &color.green, &color.blue))
 		{
 			effect->_colors.fill(color);
-			effect->setInput(effect->_priority, effect->_colors.toStdVector(), timeout, false);
+			effect->setOutput(effect->_colors, timeout);
 			return Py_BuildValue("");
 		}
 		return nullptr;
@@ -162,11 +228,11 @@ PyObject* EffectModule::wrapSetColor(PyObject *self, PyObject *args)
 			if (PyByteArray_Check(bytearray))
 			{
 				size_t length = PyByteArray_Size(bytearray);
-				if (length == 3 * effect->_hyperion->getLedCount())
+				if (length == 3 * size_t(effect->_colors.size()))
 				{
 					char * data = PyByteArray_AS_STRING(bytearray);
 					memcpy(effect->_colors.data(), data, length);
-					effect->setInput(effect->_priority, effect->_colors.toStdVector(), timeout, false);
+					effect->setOutput(effect->_colors, timeout);
 					return Py_BuildValue("");
 				}
 				else
@@ -208,7 +274,7 @@ PyObject* EffectModule::wrapSetImage(PyObject *self, PyObject *args)
 	int timeout = effect->_timeout;
 	if (timeout > 0)
 	{
-		timeout = effect->_endTime - QDateTime::currentMSecsSinceEpoch();
+		timeout = effect->_endTime - effect->currentTime();
 
 		// we are done if the time has passed
 		if (timeout <= 0)
@@ -230,7 +296,7 @@ PyObject* EffectModule::wrapSetImage(PyObject *self, PyObject *args)
 				Image<ColorRgb> image(width, height);
 				char * data = PyByteArray_AS_STRING(bytearray);
 				memcpy(image.memptr(), data, length);
-				effect->setInputImage(effect->_priority, image, timeout, false);
+				effect->setOutputImage(image, timeout);
 				return Py_BuildValue("");
 			}
 			else
@@ -271,48 +337,23 @@ PyObject* EffectModule::wrapGetImage(PyObject *self, PyObject *args)
 	if (file.mid(0, 1)  == ":")
 		file = ":/effects/"+file.mid(1);
 
-	QImageReader reader(file);
-
-	if (reader.canRead())
+	// frames are decoded once and shared between effects
+	EffectImageFrames frames;
+	QString error;
+	if (!EffectImageCache::getInstance()->getFrames(file, frames, error))
 	{
-		PyObject* result = PyList_New(reader.imageCount());
-
-		for (int i = 0; i < reader.imageCount(); ++i)
-		{
-			reader.jumpToImage(i);
-			if (reader.canRead())
-			{
-				QImage qimage = reader.read();
-
-				int width = qimage.width();
-				int height = qimage.height();
-
-				QByteArray binaryImage;
-				for (int i = 0; i<height; ++i)
-				{
-					const QRgb * scanline = reinterpret_cast<const QRgb *>(qimage.scanLine(i));
-					for (int j = 0; j< width; ++j)
-					{
-						binaryImage.append((char) qRed(scanline[j]));
-						binaryImage.append((char) qGreen(scanline[j]));
-						binaryImage.append((char) qBlue(scanline[j]));
-					}
-				}
-				PyList_SET_ITEM(result, i, Py_BuildValue("{s:i,s:i,s:O}", "imageWidth", width, "imageHeight", height, "imageData", PyByteArray_FromStringAndSize(binaryImage.constData(),binaryImage.size())));
-			}
-			else
-			{
-				PyErr_SetString(PyExc_TypeError, reader.errorString().toUtf8().constData());
-				return NULL;
-			}
-		}
-		return result;
+		PyErr_SetString(PyExc_TypeError, error.toUtf8().constData());
+		return NULL;
 	}
-	else
+
+	PyObject* result = PyList_New(frames.size());
+	for (int i = 0; i < frames.size(); ++i)
 	{
-		PyErr_SetString(PyExc_TypeError, reader.errorString().toUtf8().constData());
-		return NULL;
+		const EffectImageFrame& frame = frames.at(i);
+		PyObject* imageData = PyByteArray_FromStringAndSize(frame.data.constData(), frame.data.size());
+		PyList_SET_ITEM(result, i, Py_BuildValue("{s:i,s:i,s:N}", "imageWidth", frame.width, "imageHeight", frame.height, "imageData", imageData));
 	}
+	return result;
 }
 
 PyObject* EffectModule::wrapAbort(PyObject *self, PyObject *)
@@ -320,7 +361,7 @@ PyObject* EffectModule::wrapAbort(PyObject *self, PyObject *)
 	Effect * effect = getEffect();
 
 	// Test if the effect has reached it end time
-	if (effect->_timeout > 0 && QDateTime::currentMSecsSinceEpoch() > effect->_endTime)
+	if (effect->_timeout > 0 && effect->currentTime() > effect->_endTime)
 	{
 		effect->setInteruptionFlag();
 	}
@@ -337,7 +378,7 @@ PyObject* EffectModule::wrapImageShow(PyObject *self, PyObject *args)
 	int timeout = effect->_timeout;
 	if (timeout > 0)
 	{
-		timeout = effect->_endTime - QDateTime::currentMSecsSinceEpoch();
+		timeout = effect->_endTime - effect->currentTime();
 
 		// we are done if the time has passed
 		if (timeout <= 0)
@@ -361,25 +402,7 @@ PyObject* EffectModule::wrapImageShow(PyObject *self, PyObject *args)
 
 
 	QImage * qimage = (imgId<0) ? &(effect->_image) : &(effect->_imageStack[imgId]);
-	int width = qimage->width();
-	int height = qimage->height();
-
-	Image<ColorRgb> image(width, height);
-	QByteArray binaryImage;
-
-	for (int i = 0; i<height; ++i)
-	{
-		const QRgb * scanline = reinterpret_cast<const QRgb *>(qimage->scanLine(i));
-		for (int j = 0; j< width; ++j)
-		{
-			binaryImage.append((char) qRed(scanline[j]));
-			binaryImage.append((char) qGreen(scanline[j]));
-			binaryImage.append((char) qBlue(scanline[j]));
-		}
-	}
-
-	memcpy(image.memptr(), binaryImage.data(), binaryImage.size());
-	effect->setInputImage(effect->_priority, image, timeout, false);
+	effect->setOutputImage(*qimage, timeout);
 
 	return Py_BuildValue("");
 }
@@ -1045,6 +1068,212 @@ PyObject* EffectModule::wrapImageResetT(PyObject *self, PyObject *args)
 	return Py_BuildValue("");
 }
 
+PyObject* EffectModule::wrapLedFill(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	ColorRgb color;
+	int start = 0, count = -1;
+	if (PyArg_ParseTuple(args, "bbb|ii", &color.red, &color.green, &color.blue, &start, &count))
+	{
+		int begin, end;
+		ledRange(effect->_colors.size(), start, count, begin, end);
+		std::fill(effect->_colors.begin() + begin, effect->_colors.begin() + end, color);
+		return Py_BuildValue("");
+	}
+	return nullptr;
+}
+
+PyObject* EffectModule::wrapLedHsvGradient(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	double h1, s1, v1, h2, s2, v2;
+	int start = 0, count = -1;
+	if (PyArg_ParseTuple(args, "dddddd|ii", &h1, &s1, &v1, &h2, &s2, &v2, &start, &count))
+	{
+		int begin, end;
+		ledRange(effect->_colors.size(), start, count, begin, end);
+
+		// hsv is interpolated linear, the first and the last led get the given colors
+		const double step = (end - begin > 1) ? 1.0 / (end - begin - 1) : 0.0;
+		ColorRgb * led = effect->_colors.data() + begin;
+		for (int idx = 0; idx < end - begin; ++idx, ++led)
+		{
+			const double t = idx * step;
+			ColorSys::hsv2rgb(h1 + (h2 - h1) * t, s1 + (s2 - s1) * t, v1 + (v2 - v1) * t, led->red, led->green, led->blue);
+		}
+		return Py_BuildValue("");
+	}
+	return nullptr;
+}
+
+PyObject* EffectModule::wrapLedFade(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	double factor;
+	int start = 0, count = -1;
+	if (PyArg_ParseTuple(args, "d|ii", &factor, &start, &count))
+	{
+		int begin, end;
+		ledRange(effect->_colors.size(), start, count, begin, end);
+
+		// the channels are truncated like int(factor * value) in python
+		factor = qBound(0.0, factor, 1.0);
+		uint8_t * data = reinterpret_cast<uint8_t *>(effect->_colors.data() + begin);
+		uint8_t * dataEnd = reinterpret_cast<uint8_t *>(effect->_colors.data() + end);
+		for (; data < dataEnd; ++data)
+		{
+			*data = uint8_t(*data * factor);
+		}
+		return Py_BuildValue("");
+	}
+	return nullptr;
+}
+
+PyObject* EffectModule::wrapLedRotate(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	int steps;
+	if (PyArg_ParseTuple(args, "i", &steps))
+	{
+		// positive steps move the colors to higher led indices
+		const int size = effect->_colors.size();
+		if (size > 0)
+		{
+			steps %= size;
+			if (steps < 0)
+			{
+				steps += size;
+			}
+			std::rotate(effect->_colors.begin(), effect->_colors.end() - steps, effect->_colors.end());
+		}
+		return Py_BuildValue("");
+	}
+	return nullptr;
+}
+
+PyObject* EffectModule::wrapLedShift(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	int steps;
+	ColorRgb color = ColorRgb::BLACK;
+	if (PyArg_ParseTuple(args, "i|bbb", &steps, &color.red, &color.green, &color.blue))
+	{
+		// positive steps move the colors to higher led indices, the vacated leds get the color
+		QVector<ColorRgb> & colors = effect->_colors;
+		const int size = colors.size();
+		const int shift = qBound(-size, steps, size);
+		if (shift > 0)
+		{
+			std::copy_backward(colors.begin(), colors.end() - shift, colors.end());
+			std::fill(colors.begin(), colors.begin() + shift, color);
+		}
+		else if (shift < 0)
+		{
+			std::copy(colors.begin() - shift, colors.end(), colors.begin());
+			std::fill(colors.end() + shift, colors.end(), color);
+		}
+		return Py_BuildValue("");
+	}
+	return nullptr;
+}
+
+PyObject* EffectModule::wrapLedBlend(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	PyObject * bytearray = nullptr;
+	double factor;
+	if (PyArg_ParseTuple(args, "Od", &bytearray, &factor))
+	{
+		if (!PyByteArray_Check(bytearray))
+		{
+			PyErr_SetString(PyExc_RuntimeError, "Argument is not a bytearray");
+			return nullptr;
+		}
+
+		const int length = PyByteArray_Size(bytearray);
+		if (length != 3 * effect->_colors.size())
+		{
+			PyErr_SetString(PyExc_RuntimeError, "Length of bytearray argument should be 3*ledCount");
+			return nullptr;
+		}
+
+		// buffer = buffer * (1 - factor) + bytearray * factor
+		const unsigned scale = unsigned(qBound(0.0, factor, 1.0) * 256.0);
+		const uint8_t * other = reinterpret_cast<const uint8_t *>(PyByteArray_AS_STRING(bytearray));
+		uint8_t * data = reinterpret_cast<uint8_t *>(effect->_colors.data());
+		for (int idx = 0; idx < length; ++idx)
+		{
+			data[idx] = uint8_t((data[idx] * (256 - scale) + other[idx] * scale) >> 8);
+		}
+		return Py_BuildValue("");
+	}
+	return nullptr;
+}
+
+PyObject* EffectModule::wrapLedGet(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+	return PyByteArray_FromStringAndSize(reinterpret_cast<const char *>(effect->_colors.constData()), 3 * effect->_colors.size());
+}
+
+PyObject* EffectModule::wrapLedShow(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	// check if we have aborted already
+	if (effect->hasInteruptionFlag())
+	{
+		return Py_BuildValue("");
+	}
+
+	// determine the timeout
+	int timeout = effect->_timeout;
+	if (timeout > 0)
+	{
+		timeout = effect->_endTime - effect->currentTime();
+
+		// we are done if the time has passed
+		if (timeout <= 0)
+		{
+			return Py_BuildValue("");
+		}
+	}
+
+	effect->setOutput(effect->_colors, timeout);
+	return Py_BuildValue("");
+}
+
+PyObject* EffectModule::wrapClockTime(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+	return Py_BuildValue("d", effect->currentTime() / 1000.0);
+}
+
+PyObject* EffectModule::wrapClockSleep(PyObject *self, PyObject *args)
+{
+	Effect * effect = getEffect();
+
+	double seconds;
+	if (PyArg_ParseTuple(args, "d", &seconds))
+	{
+		effect->waitFor(int(seconds * 1000.0));
+		return Py_BuildValue("");
+	}
+	return nullptr;
+}
+
+void EffectModule::ledRange(int size, int start, int count, int & begin, int & end)
+{
+	begin = qBound(0, start, size);
+	end = (count < 0) ? size : begin + qMin(count, size - begin);
+}
+
 Effect * EffectModule::getEffect()
 {
 	// extract the module from the runtime
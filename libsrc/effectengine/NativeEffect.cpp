@@ -0,0 +1,104 @@
+// stl includes
+#include <map>
+
+// Qt includes
+#include <QJsonArray>
+
+// effect engine includes
+#include <effectengine/NativeEffect.h>
+#include "NativeEffects.h"
+
+namespace {
+
+typedef NativeEffect* (*NativeEffectConstructor)();
+
+template <typename Effect_T>
+NativeEffect* construct()
+{
+	return new Effect_T();
+}
+
+/// All native effects by name
+const std::map<QString, NativeEffectConstructor>& nativeEffects()
+{
+	static const std::map<QString, NativeEffectConstructor> effects =
+	{
+		{ "swirl",        construct<SwirlEffect> },
+		{ "knight-rider", construct<KnightRiderEffect> },
+		{ "mood-blobs",   construct<MoodBlobsEffect> }
+	};
+	return effects;
+}
+
+} // end anonymous namespace
+
+NativeEffect::NativeEffect()
+	: _ledCount(0)
+	, _latchTime(0)
+	, _colors()
+	, _image()
+	, _imageOutput(false)
+{
+}
+
+NativeEffect::~NativeEffect()
+{
+}
+
+NativeEffect* NativeEffect::create(const QString& script)
+{
+	if (!script.startsWith(NATIVE_EFFECT_PREFIX))
+		return nullptr;
+
+	const auto it = nativeEffects().find(script.mid(QString(NATIVE_EFFECT_PREFIX).length()));
+	return (it != nativeEffects().end()) ? it->second() : nullptr;
+}
+
+bool NativeEffect::isNative(const QString& script)
+{
+	return script.startsWith(NATIVE_EFFECT_PREFIX)
+		&& nativeEffects().count(script.mid(QString(NATIVE_EFFECT_PREFIX).length())) > 0;
+}
+
+QStringList NativeEffect::availableEffects()
+{
+	QStringList scripts;
+	for (const auto& effect : nativeEffects())
+	{
+		scripts << NATIVE_EFFECT_PREFIX + effect.first;
+	}
+	return scripts;
+}
+
+void NativeEffect::setup(const QJsonObject& args, int ledCount, int latchTime, const QSize& imageSize)
+{
+	_ledCount = ledCount;
+	_latchTime = latchTime;
+	_colors.fill(ColorRgb::BLACK, ledCount);
+	_image = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+	_image.fill(Qt::black);
+
+	init(args);
+}
+
+void NativeEffect::imageMinSize(int width, int height)
+{
+	if (_image.width() < width || _image.height() < height)
+	{
+		_image = _image.scaled(qMax(_image.width(), width), qMax(_image.height(), height), Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	}
+}
+
+int NativeEffect::frameTime(double seconds) const
+{
+	return qMax(_latchTime, qRound(seconds * 1000.0));
+}
+
+ColorRgb NativeEffect::toColor(const QJsonValue& value, const ColorRgb& defaultColor)
+{
+	const QJsonArray color = value.toArray();
+	if (color.size() < 3)
+		return defaultColor;
+
+	return ColorRgb{uint8_t(color[0].toInt()), uint8_t(color[1].toInt()), uint8_t(color[2].toInt())};
+}
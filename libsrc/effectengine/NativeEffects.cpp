@@ -0,0 +1,413 @@
+// stl includes
+#include <cmath>
+#include <algorithm>
+
+// Qt includes
+#include <QPainter>
+#include <QConicalGradient>
+#include <QtGlobal>
+
+// effect engine includes
+#include "NativeEffects.h"
+
+// utils includes
+#include <utils/ColorSys.h>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+/// modulo with a positive result like python
+double pmod(double value, double divisor)
+{
+	const double result = std::fmod(value, divisor);
+	return (result < 0) ? result + divisor : result;
+}
+
+/// colorsys.rgb_to_hsv
+void rgbToHsv(double r, double g, double b, double& h, double& s, double& v)
+{
+	const double maxc = std::max(r, std::max(g, b));
+	const double minc = std::min(r, std::min(g, b));
+	v = maxc;
+	if (minc == maxc)
+	{
+		h = s = 0.0;
+		return;
+	}
+
+	s = (maxc - minc) / maxc;
+	const double rc = (maxc - r) / (maxc - minc);
+	const double gc = (maxc - g) / (maxc - minc);
+	const double bc = (maxc - b) / (maxc - minc);
+	if (r == maxc)
+		h = bc - gc;
+	else if (g == maxc)
+		h = 2.0 + rc - bc;
+	else
+		h = 4.0 + gc - rc;
+	h = pmod(h / 6.0, 1.0);
+}
+
+} // end anonymous namespace
+
+SwirlEffect::SwirlEffect()
+	: NativeEffect()
+	, _sleepTime(0)
+	, _enableSecond(false)
+	, _center()
+	, _center2()
+	, _angle(0)
+	, _angle2(0)
+	, _increment(1)
+	, _increment2(-1)
+	, _stops()
+	, _stops2()
+{
+}
+
+void SwirlEffect::init(const QJsonObject& args)
+{
+	// set minimum image size
+	imageMinSize(64, 64);
+
+	const double rotationTime = args["rotation-time"].toDouble(10.0);
+	_center  = getPoint(args["random-center"].toBool(false), args["center_x"].toDouble(0.5), args["center_y"].toDouble(0.5));
+	_center2 = getPoint(args["random-center2"].toBool(false), args["center_x2"].toDouble(0.5), args["center_y2"].toDouble(0.5));
+	_increment  = args["reverse"].toBool(false) ? -1 : 1;
+	_increment2 = args["reverse2"].toBool(true) ? -1 : 1;
+	_sleepTime = frameTime(qMax(0.1, rotationTime) / 360.0);
+
+	// the defaults of swirl.py if the colors are not given at all
+	QJsonArray colors = args["custom-colors"].toArray();
+	if (!args.contains("custom-colors"))
+	{
+		colors = { QJsonArray{ 255, 0, 0 }, QJsonArray{ 0, 255, 0 }, QJsonArray{ 0, 0, 255 } };
+	}
+
+	QJsonArray colors2 = args["custom-colors2"].toArray();
+	if (!args.contains("custom-colors2"))
+	{
+		const QJsonArray white = { 255, 255, 255, 1 };
+		const QJsonArray clear = { 0, 255, 255, 0 };
+		colors2 = { QJsonArray{ 255, 255, 255, 0 }, clear, white, clear, clear, clear, white, clear, clear, clear, white, clear };
+	}
+
+	if (colors.size() > 1)
+	{
+		_stops = buildGradient(colors);
+	}
+	else
+	{
+		QConicalGradient rainbow;
+		rainbow.setColorAt(  0/255.0, QColor(255,   0,   0));
+		rainbow.setColorAt( 25/255.0, QColor(255, 230,   0));
+		rainbow.setColorAt( 63/255.0, QColor(255, 255,   0));
+		rainbow.setColorAt(100/255.0, QColor(  0, 255,   0));
+		rainbow.setColorAt(127/255.0, QColor(  0, 255, 200));
+		rainbow.setColorAt(159/255.0, QColor(  0, 255, 255));
+		rainbow.setColorAt(191/255.0, QColor(  0,   0, 255));
+		rainbow.setColorAt(224/255.0, QColor(255,   0, 255));
+		rainbow.setColorAt(255/255.0, QColor(255,   0, 127));
+		_stops = rainbow.stops();
+	}
+
+	_enableSecond = args["enable-second"].toBool(false) && colors2.size() > 1;
+	if (_enableSecond)
+	{
+		_stops2 = buildGradient(colors2);
+	}
+
+	_imageOutput = true;
+}
+
+int SwirlEffect::render()
+{
+	_angle += _increment;
+	if (_angle > 360) _angle = 0;
+	if (_angle < 0)   _angle = 360;
+
+	_angle2 += _increment2;
+	if (_angle2 > 360) _angle2 = 0;
+	if (_angle2 < 0)   _angle2 = 360;
+
+	QPainter painter(&_image);
+
+	QConicalGradient gradient(_center, _angle);
+	gradient.setStops(_stops);
+	painter.fillRect(_image.rect(), gradient);
+
+	if (_enableSecond)
+	{
+		QConicalGradient gradient2(_center2, _angle2);
+		gradient2.setStops(_stops2);
+		painter.fillRect(_image.rect(), gradient2);
+	}
+
+	return _sleepTime;
+}
+
+QPoint SwirlEffect::getPoint(bool random, double x, double y) const
+{
+	if (random)
+	{
+		x = qrand() / double(RAND_MAX);
+		y = qrand() / double(RAND_MAX);
+	}
+	return QPoint(qRound(x * _image.width()), qRound(y * _image.height()));
+}
+
+QGradientStops SwirlEffect::buildGradient(const QJsonArray& colors)
+{
+	// the stop positions are distributed by color count, the last color is also the first one
+	QConicalGradient gradient;
+	const int posfac = 255 / colors.size();
+	int pos = 0;
+
+	for (const QJsonValue& value : colors)
+	{
+		const QJsonArray color = value.toArray();
+		const int alpha = (color.size() == 4) ? int(color[3].toDouble() * 255) : 255;
+		pos += posfac;
+		gradient.setColorAt(pos / 255.0, QColor(color[0].toInt(), color[1].toInt(), color[2].toInt(), alpha));
+	}
+
+	const QJsonArray last = colors.last().toArray();
+	const int alpha = (last.size() == 4) ? int(last[3].toDouble() * 255) : 255;
+	gradient.setColorAt(0.0, QColor(last[0].toInt(), last[1].toInt(), last[2].toInt(), alpha));
+
+	return gradient.stops();
+}
+
+KnightRiderEffect::KnightRiderEffect()
+	: NativeEffect()
+	, _sleepTime(0)
+	, _increment(1)
+	, _fadeFactor(0.7f)
+	, _color(ColorRgb::RED)
+	, _position(0)
+	, _direction(1)
+	, _data()
+{
+}
+
+void KnightRiderEffect::init(const QJsonObject& args)
+{
+	const double speed = qMax(0.0001, args["speed"].toDouble(1.0));
+	_fadeFactor = float(qBound(0.0, args["fadeFactor"].toDouble(0.7), 1.0));
+	_color = toColor(args["color"], ColorRgb::RED);
+
+	// initialize the led data
+	const int width = 25;
+	_data.fill(ColorRgb::BLACK, width);
+	_data[0] = _color;
+	_image = QImage(width, 1, QImage::Format_RGB32);
+
+	// calculate the sleep time and rotation increment
+	double sleepTime = 1.0 / (speed * width);
+	while (sleepTime < 0.05)
+	{
+		_increment *= 2;
+		sleepTime *= 2;
+	}
+	_sleepTime = qRound(sleepTime * 1000.0);
+
+	_imageOutput = true;
+}
+
+int KnightRiderEffect::render()
+{
+	const int width = _data.size();
+
+	// output the current state
+	QRgb* pixel = reinterpret_cast<QRgb*>(_image.scanLine(0));
+	for (int i = 0; i < width; ++i)
+	{
+		pixel[i] = qRgb(_data[i].red, _data[i].green, _data[i].blue);
+	}
+
+	// move data into next state
+	for (int i = 0; i < _increment; ++i)
+	{
+		_position += _direction;
+		if (_position == -1)
+		{
+			_position = 1;
+			_direction = 1;
+		}
+		else if (_position == width)
+		{
+			_position = width - 2;
+			_direction = -1;
+		}
+
+		// fade the old data
+		for (ColorRgb& color : _data)
+		{
+			color.red   = uint8_t(_fadeFactor * color.red);
+			color.green = uint8_t(_fadeFactor * color.green);
+			color.blue  = uint8_t(_fadeFactor * color.blue);
+		}
+
+		// insert new data
+		_data[_position] = _color;
+	}
+
+	return _sleepTime;
+}
+
+MoodBlobsEffect::MoodBlobsEffect()
+	: NativeEffect()
+	, _hueChange(0.0)
+	, _blobs(5)
+	, _saturation(1.0)
+	, _value(1.0)
+	, _baseColorChange(false)
+	, _baseColorRangeLeft(0.0)
+	, _baseColorRangeRight(1.0)
+	, _baseColorChangeRate(10.0)
+	, _baseColorChangeIncreaseValue(1.0 / 360.0)
+	, _fullColorWheelAvailable(true)
+	, _amplitudePhaseIncrement(0.0)
+	, _colorDataIncrement(1)
+	, _colorData()
+	, _amplitudePhase(0.0)
+	, _rotateColors(false)
+	, _baseColorChangeStepCount(0)
+	, _baseHSVValue(0.0)
+	, _numberOfRotates(0)
+{
+}
+
+void MoodBlobsEffect::init(const QJsonObject& args)
+{
+	double rotationTime = args["rotationTime"].toDouble(20.0);
+	const ColorRgb color = toColor(args["color"], ColorRgb::BLUE);
+	const bool colorRandom = args["colorRandom"].toBool(false);
+	double hueChange = args["hueChange"].toDouble(60.0);
+	_blobs = args["blobs"].toInt(5);
+	const bool reverse = args["reverse"].toBool(false);
+	_baseColorChange = args["baseChange"].toBool(false);
+	double baseColorRangeLeft = args["baseColorRangeLeft"].toDouble(0.0);
+	double baseColorRangeRight = args["baseColorRangeRight"].toDouble(360.0);
+	double baseColorChangeRate = args["baseColorChangeRate"].toDouble(10.0);
+
+	// switch baseColor change off if left and right are too close together to see a difference in color
+	if ((baseColorRangeRight > baseColorRangeLeft && (baseColorRangeRight - baseColorRangeLeft) < 10) ||
+		(baseColorRangeLeft > baseColorRangeRight && ((baseColorRangeRight + 360) - baseColorRangeLeft) < 10))
+	{
+		_baseColorChange = false;
+	}
+
+	// 360 -> 1
+	_fullColorWheelAvailable = pmod(baseColorRangeRight, 360) == pmod(baseColorRangeLeft, 360);
+	_baseColorChangeIncreaseValue = 1.0 / 360.0;
+	_baseColorRangeLeft = baseColorRangeLeft / 360.0;
+	_baseColorRangeRight = baseColorRangeRight / 360.0;
+
+	// check parameters
+	rotationTime = qMax(0.1, rotationTime);
+	_hueChange = qMax(0.0, qMin(std::abs(hueChange / 360.0), 0.5));
+	_blobs = qMax(1, _blobs);
+	baseColorChangeRate = qMax(0.0, baseColorChangeRate);
+
+	// calculate the color data
+	double hue;
+	rgbToHsv(color.red / 255.0, color.green / 255.0, color.blue / 255.0, hue, _saturation, _value);
+	if (colorRandom)
+	{
+		hue = qrand() / (double(RAND_MAX) + 1.0);
+	}
+	_baseHSVValue = hue;
+	buildColorData(_baseHSVValue);
+
+	// calculate the increments
+	const double sleepTime = 0.1;
+	_amplitudePhaseIncrement = _blobs * PI * sleepTime / rotationTime;
+	_colorDataIncrement = 1;
+	_baseColorChangeRate = baseColorChangeRate / sleepTime;
+
+	// switch direction if needed
+	if (reverse)
+	{
+		_amplitudePhaseIncrement = -_amplitudePhaseIncrement;
+		_colorDataIncrement = -_colorDataIncrement;
+	}
+
+	_imageOutput = false;
+}
+
+void MoodBlobsEffect::buildColorData(double baseHue)
+{
+	_colorData.resize(_ledCount);
+	for (int i = 0; i < _ledCount; ++i)
+	{
+		const double hue = pmod(baseHue + _hueChange * std::sin(2 * PI * i / _ledCount), 1.0);
+		ColorSys::hsv2rgb(hue, _saturation, _value, _colorData[i].red, _colorData[i].green, _colorData[i].blue);
+	}
+}
+
+int MoodBlobsEffect::render()
+{
+	// move the basecolor
+	if (_baseColorChange)
+	{
+		// every baseColorChangeRate seconds
+		if (_baseColorChangeStepCount >= _baseColorChangeRate)
+		{
+			_baseColorChangeStepCount = 0;
+			// cyclic increment when the full colorwheel is available, move up and down otherwise
+			if (_fullColorWheelAvailable)
+			{
+				_baseHSVValue = pmod(_baseHSVValue + _baseColorChangeIncreaseValue, _baseColorRangeRight);
+			}
+			else
+			{
+				// switch increment direction if baseHSV <= left or baseHSV >= right
+				if (_baseColorChangeIncreaseValue < 0 && _baseHSVValue > _baseColorRangeLeft && (_baseHSVValue + _baseColorChangeIncreaseValue) <= _baseColorRangeLeft)
+				{
+					_baseColorChangeIncreaseValue = std::abs(_baseColorChangeIncreaseValue);
+				}
+				else if (_baseColorChangeIncreaseValue > 0 && _baseHSVValue < _baseColorRangeRight && (_baseHSVValue + _baseColorChangeIncreaseValue) >= _baseColorRangeRight)
+				{
+					_baseColorChangeIncreaseValue = -std::abs(_baseColorChangeIncreaseValue);
+				}
+
+				_baseHSVValue = pmod(_baseHSVValue + _baseColorChangeIncreaseValue, 1.0);
+			}
+
+			// update color values and restore the rotation
+			buildColorData(_baseHSVValue);
+			if (_colorDataIncrement > 0)
+				std::rotate(_colorData.begin(), _colorData.end() - _numberOfRotates, _colorData.end());
+			else
+				std::rotate(_colorData.begin(), _colorData.begin() + _numberOfRotates, _colorData.end());
+		}
+
+		++_baseColorChangeStepCount;
+	}
+
+	// calculate new colors
+	for (int i = 0; i < _ledCount; ++i)
+	{
+		const double amplitude = qMax(0.0, std::sin(-_amplitudePhase + 2 * PI * _blobs * i / _ledCount));
+		_colors[i].red   = uint8_t(_colorData[i].red   * amplitude);
+		_colors[i].green = uint8_t(_colorData[i].green * amplitude);
+		_colors[i].blue  = uint8_t(_colorData[i].blue  * amplitude);
+	}
+
+	// increment the phase
+	_amplitudePhase = pmod(_amplitudePhase + _amplitudePhaseIncrement, 2 * PI);
+
+	if (_rotateColors && _ledCount > 0)
+	{
+		if (_colorDataIncrement > 0)
+			std::rotate(_colorData.begin(), _colorData.end() - 1, _colorData.end());
+		else
+			std::rotate(_colorData.begin(), _colorData.begin() + 1, _colorData.end());
+		_numberOfRotates = (_numberOfRotates + 1) % _ledCount;
+	}
+	_rotateColors = !_rotateColors;
+
+	return 100;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// Qt includes
+#include <QGradient>
+#include <QPoint>
+#include <QJsonArray>
+
+// effect engine includes
+#include <effectengine/NativeEffect.h>
+
+///
+/// Port of swirl.py, one or two rotating conical gradients
+///
+class SwirlEffect : public NativeEffect
+{
+public:
+	SwirlEffect();
+
+	virtual int render();
+
+protected:
+	virtual void init(const QJsonObject& args);
+
+private:
+	/// Convert a relative center or a random one to canvas coordinates
+	QPoint getPoint(bool random, double x, double y) const;
+
+	/// Gradient stops from colors [r,g,b] or [r,g,b,alpha], the last color closes the circle
+	static QGradientStops buildGradient(const QJsonArray& colors);
+
+	int _sleepTime;
+	bool _enableSecond;
+	QPoint _center;
+	QPoint _center2;
+	int _angle;
+	int _angle2;
+	int _increment;
+	int _increment2;
+	QGradientStops _stops;
+	QGradientStops _stops2;
+};
+
+///
+/// Port of knight-rider.py, a bouncing dot with a fading trail
+///
+class KnightRiderEffect : public NativeEffect
+{
+public:
+	KnightRiderEffect();
+
+	virtual int render();
+
+protected:
+	virtual void init(const QJsonObject& args);
+
+private:
+	int _sleepTime;
+	int _increment;
+	float _fadeFactor;
+	ColorRgb _color;
+	int _position;
+	int _direction;
+	QVector<ColorRgb> _data;
+};
+
+///
+/// Port of mood-blobs.py, blobs of a color moving around the leds
+///
+class MoodBlobsEffect : public NativeEffect
+{
+public:
+	MoodBlobsEffect();
+
+	virtual int render();
+
+protected:
+	virtual void init(const QJsonObject& args);
+
+private:
+	/// Calculate the colors around the base hue
+	void buildColorData(double baseHue);
+
+	double _hueChange;
+	int _blobs;
+	double _saturation;
+	double _value;
+	bool _baseColorChange;
+	double _baseColorRangeLeft;
+	double _baseColorRangeRight;
+	double _baseColorChangeRate;
+	double _baseColorChangeIncreaseValue;
+	bool _fullColorWheelAvailable;
+	double _amplitudePhaseIncrement;
+	int _colorDataIncrement;
+	QVector<ColorRgb> _colorData;
+	double _amplitudePhase;
+	bool _rotateColors;
+	int _baseColorChangeStepCount;
+	double _baseHSVValue;
+	int _numberOfRotates;
+};
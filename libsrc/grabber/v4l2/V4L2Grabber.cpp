@@ -21,6 +21,7 @@
 #include <QTimer>
 
 #include "grabber/V4L2Grabber.h"
+#include <utils/LatencyTracer.h>
 
 #define CLEAR(x) memset(&(x), 0, sizeof(x))
 
@@ -853,6 +854,7 @@ bool V4L2Grabber::process_image(const void *p, int size)
 
 void V4L2Grabber::process_image(const uint8_t * data)
 {
+	const int64_t captureTime = LatencyTracer::now();
 	Image<ColorRgb> image(0, 0);
 	_imageResampler.processImage(data, _width, _height, _lineLength, _pixelFormat, image);
 
@@ -895,6 +897,8 @@ void V4L2Grabber::process_image(const uint8_t * data)
 
 		if ( _noSignalCounter < _noSignalCounterThreshold)
 		{
+			LatencyTracer::record(LatencyTracer::GRAB, LatencyTracer::now() - captureTime);
+			LatencyTracer::markCapture(captureTime, hyperion::COMP_V4L);
 			emit newFrame(image);
 		}
 		else if (_noSignalCounter == _noSignalCounterThreshold)
@@ -905,6 +909,8 @@ void V4L2Grabber::process_image(const uint8_t * data)
 	}
 	else
 	{
+		LatencyTracer::record(LatencyTracer::GRAB, LatencyTracer::now() - captureTime);
+		LatencyTracer::markCapture(captureTime, hyperion::COMP_V4L);
 		emit newFrame(image);
 	}
 }
@@ -0,0 +1,116 @@
+// STL includes
+#include <algorithm>
+
+// Hyperion includes
+#include <hyperion/Hyperion.h>
+#include <hyperion/Compositor.h>
+
+using namespace hyperion;
+
+Compositor::Compositor(const LedString& ledString, Hyperion* hyperion)
+	: QObject(hyperion)
+	, _log(Logger::getInstance("HYPERION"))
+	, _ledString(ledString)
+	, _imageToLeds(nullptr)
+	, _imageColors()
+	, _enabled(false)
+	, _layerCount(2)
+	, _mode(BLEND_ALPHA)
+	, _alpha(256)
+{
+	// init
+	handleSettingsUpdate(settings::COMPOSITOR, hyperion->getSetting(settings::COMPOSITOR));
+	// listen for config changes
+	connect(hyperion, &Hyperion::settingsChanged, this, &Compositor::handleSettingsUpdate);
+}
+
+Compositor::~Compositor()
+{
+	delete _imageToLeds;
+}
+
+Compositor::BlendMode Compositor::stringToBlendMode(const QString& mode)
+{
+	if (mode == "additive")
+		return BLEND_ADDITIVE;
+	if (mode == "max")
+		return BLEND_MAX;
+
+	return BLEND_ALPHA;
+}
+
+void Compositor::handleSettingsUpdate(const settings::type& type, const QJsonDocument& config)
+{
+	if(type == settings::COMPOSITOR)
+	{
+		const QJsonObject& obj = config.object();
+		_enabled    = obj["enable"].toBool(false);
+		_layerCount = qBound(2, obj["layers"].toInt(2), 8);
+		_mode       = stringToBlendMode(obj["mode"].toString("alpha"));
+		_alpha      = unsigned(qBound(0, obj["opacity"].toInt(100), 100) * 256 / 100);
+
+		Debug(_log, "Compositing %s, %d layers, mode %s", _enabled ? "enabled" : "disabled", _layerCount, QSTRING_CSTR(obj["mode"].toString("alpha")));
+	}
+}
+
+void Compositor::setLedString(const LedString& ledString)
+{
+	_ledString = ledString;
+
+	delete _imageToLeds;
+	_imageToLeds = nullptr;
+}
+
+void Compositor::blend(const std::vector<ColorRgb>& ledColors, std::vector<ColorRgb>& result) const
+{
+	// plain loops over the color bytes, so the compiler can vectorize them
+	const size_t size = 3 * std::min(ledColors.size(), result.size());
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(ledColors.data());
+	uint8_t* dst = reinterpret_cast<uint8_t*>(result.data());
+
+	switch (_mode)
+	{
+		case BLEND_ADDITIVE:
+			for (size_t i = 0; i < size; ++i)
+			{
+				const unsigned value = dst[i] + src[i];
+				dst[i] = uint8_t(value > 255 ? 255 : value);
+			}
+			break;
+
+		case BLEND_MAX:
+			for (size_t i = 0; i < size; ++i)
+			{
+				dst[i] = std::max(dst[i], src[i]);
+			}
+			break;
+
+		default:
+			for (size_t i = 0; i < size; i += 3)
+			{
+				// black leds don't cover the layers below
+				const unsigned alpha = (src[i] | src[i+1] | src[i+2]) ? _alpha : 0;
+				dst[i  ] = uint8_t((src[i  ] * alpha + dst[i  ] * (256 - alpha)) >> 8);
+				dst[i+1] = uint8_t((src[i+1] * alpha + dst[i+1] * (256 - alpha)) >> 8);
+				dst[i+2] = uint8_t((src[i+2] * alpha + dst[i+2] * (256 - alpha)) >> 8);
+			}
+	}
+}
+
+void Compositor::blend(const Image<ColorRgb>& image, std::vector<ColorRgb>& result)
+{
+	if (image.width() == 0 || image.height() == 0)
+	{
+		return;
+	}
+
+	if (_imageToLeds == nullptr || _imageToLeds->width() != image.width() || _imageToLeds->height() != image.height())
+	{
+		delete _imageToLeds;
+		_imageToLeds = new ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds());
+	}
+
+	_imageColors.resize(_ledString.leds().size());
+	_imageToLeds->getMeanLedColor(image, _imageColors);
+	blend(_imageColors, result);
+}
@@ -20,10 +20,12 @@
 #include <hyperion/Hyperion.h>
 #include <hyperion/MessageForwarder.h>
 #include <hyperion/ImageProcessor.h>
+#include <hyperion/Compositor.h>
 #include <hyperion/ColorAdjustment.h>
 
 // utils
 #include <utils/hyperion.h>
+#include <utils/LatencyTracer.h>
 
 // Leddevice includes
 #include <leddevice/LedDevice.h>
@@ -84,6 +86,7 @@ Hyperion::Hyperion(HyperionDaemon* daemon, const quint8& instance, const QString
 	, _ledString(hyperion::createLedString(getSetting(settings::LEDS).array(), hyperion::createColorOrder(getSetting(settings::DEVICE).object())))
 	, _ledStringClone(hyperion::createLedStringClone(getSetting(settings::LEDS).array(), hyperion::createColorOrder(getSetting(settings::DEVICE).object())))
 	, _imageProcessor(new ImageProcessor(_ledString, this))
+	, _compositor(new Compositor(_ledString, this))
 	, _muxer(_ledString.leds().size())
 	, _raw2ledAdjustment(hyperion::createLedColorsAdjustment(_ledString.leds().size(), getSetting(settings::COLOR).object()))
 	, _effectEngine(nullptr)
@@ -96,6 +99,7 @@ Hyperion::Hyperion(HyperionDaemon* daemon, const quint8& instance, const QString
 	, _configHash()
 	, _ledGridSize(hyperion::getLedLayoutGridSize(getSetting(settings::LEDS).array()))
 	, _prevCompId(hyperion::COMP_INVALID)
+	, _prevBaseCompId(hyperion::COMP_INVALID)
 	, _ledBuffer(_ledString.leds().size(), ColorRgb::BLACK)
 {
 	if (!_raw2ledAdjustment->verifyAdjustments())
@@ -118,6 +122,8 @@ Hyperion::Hyperion(HyperionDaemon* daemon, const quint8& instance, const QString
 
 	// connect Hyperion::update with Muxer visible priority changes as muxer updates independent
 	connect(&_muxer, &PriorityMuxer::visiblePriorityChanged, this, &Hyperion::update);
+	connect(&_muxer, &PriorityMuxer::priorityChanged, this, &Hyperion::compositionChanged);
+	connect(&_muxer, &PriorityMuxer::activeStateChanged, this, &Hyperion::compositionChanged);
 
 	// listens for ComponentRegister changes of COMP_ALL to perform core enable/disable actions
 	connect(&_componentRegister, &ComponentRegister::updatedComponentState, this, &Hyperion::updatedComponentState);
@@ -231,6 +237,7 @@ void Hyperion::handleSettingsUpdate(const settings::type& type, const QJsonDocum
 		_ledString = hyperion::createLedString(leds, hyperion::createColorOrder(getSetting(settings::DEVICE).object()));
 		_ledStringClone = hyperion::createLedStringClone(leds, hyperion::createColorOrder(getSetting(settings::DEVICE).object()));
 		_imageProcessor->setLedString(_ledString);
+		_compositor->setLedString(_ledString);
 		_muxer.updateLedColorsLength(_ledString.leds().size());
 		_ledGridSize = hyperion::getLedLayoutGridSize(leds);
 
@@ -277,6 +284,7 @@ void Hyperion::handleSettingsUpdate(const settings::type& type, const QJsonDocum
 			_ledString = hyperion::createLedString(getSetting(settings::LEDS).array(), hyperion::createColorOrder(dev));
 			_ledStringClone = hyperion::createLedStringClone(getSetting(settings::LEDS).array(), hyperion::createColorOrder(dev));
 			_imageProcessor->setLedString(_ledString);
+			_compositor->setLedString(_ledString);
 		}
 
 	/*	// reinit led device type on change
@@ -410,14 +418,17 @@ void Hyperion::registerInput(const int priority, const hyperion::Components& com
 
 const bool Hyperion::setInput(const int priority, const std::vector<ColorRgb>& ledColors, int timeout_ms, const bool& clearEffect)
 {
+	const int64_t muxStart = LatencyTracer::now();
 	if(_muxer.setInput(priority, ledColors, timeout_ms))
 	{
+		LatencyTracer::record(LatencyTracer::MUX, LatencyTracer::now() - muxStart);
+
 		// clear effect if this call does not come from an effect
 		if(clearEffect)
 			_effectEngine->channelCleared(priority);
 
 		// if this priority is visible, update immediately
-		if(priority == _muxer.getCurrentPriority())
+		if(isVisiblePriority(priority))
 			update();
 
 		return true;
@@ -427,17 +438,25 @@ const bool Hyperion::setInput(const int priority, const std::vector<ColorRgb>& l
 
 const bool Hyperion::setInputImage(const int priority, const Image<ColorRgb>& image, int64_t timeout_ms, const bool& clearEffect)
 {
+	const int64_t muxStart = LatencyTracer::now();
 	if(_muxer.setInputImage(priority, image, timeout_ms))
 	{
+		LatencyTracer::record(LatencyTracer::MUX, LatencyTracer::now() - muxStart);
+
 		// clear effect if this call does not come from an effect
 		if(clearEffect)
 			_effectEngine->channelCleared(priority);
 
 		// if this priority is visible, update immediately
-		if(priority == _muxer.getCurrentPriority())
+		if(isVisiblePriority(priority))
 		{
 			update();
 		}
+		else
+		{
+			// a captured frame of a hidden priority never reaches the leds
+			LatencyTracer::discardCapture(_muxer.getInputInfo(priority).componentId);
+		}
 
 		return true;
 	}
@@ -506,6 +525,15 @@ int Hyperion::getCurrentPriority() const
 	return _muxer.getCurrentPriority();
 }
 
+bool Hyperion::isVisiblePriority(const int priority) const
+{
+	if (priority == _muxer.getCurrentPriority())
+		return true;
+
+	const int layerCount = _compositor->getLayerCount();
+	return layerCount > 1 && _muxer.getVisiblePriorities(layerCount).contains(priority);
+}
+
 bool Hyperion::isCurrentPriority(const int priority) const
 {
 	return getCurrentPriority() == priority;
@@ -516,7 +544,7 @@ QList<int> Hyperion::getActivePriorities() const
 	return _muxer.getPriorities();
 }
 
-const Hyperion::InputInfo Hyperion::getPriorityInfo(const int priority) const
+const Hyperion::InputInfo& Hyperion::getPriorityInfo(const int priority) const
 {
 	return _muxer.getInputInfo(priority);
 }
@@ -601,6 +629,12 @@ void Hyperion::updatedComponentState(const hyperion::Components comp, const bool
 	}
 }
 
+void Hyperion::compositionChanged()
+{
+	if (_compositor->getLayerCount() > 1)
+		update();
+}
+
 void Hyperion::update()
 {
 	if(_lockUpdate)
@@ -610,9 +644,11 @@ void Hyperion::update()
 	if(_hwLedCount > _ledBuffer.size())
 		_ledBuffer.resize(getLedCount());
 
-	// Obtain the current priority channel
-	int priority = _muxer.getCurrentPriority();
-	const PriorityMuxer::InputInfo priorityInfo = _muxer.getInputInfo(priority);
+	// Obtain the current priority channel, it selects the smoothing and the backlight.
+	// With compositing the lowest visible priority is the base layer, which is mapped to the leds
+	const QList<int> layers = _muxer.getVisiblePriorities(_compositor->getLayerCount());
+	const PriorityMuxer::InputInfo& priorityInfo = _muxer.getInputInfo(layers.first());
+	const PriorityMuxer::InputInfo& baseInfo = _muxer.getInputInfo(layers.last());
 
 	// eval comp change
 	bool compChanged = false;
@@ -621,28 +657,52 @@ void Hyperion::update()
 		compChanged = true;
 		_prevCompId = priorityInfo.componentId;
 	}
+	bool baseCompChanged = false;
+	if (baseInfo.componentId != _prevBaseCompId)
+	{
+		baseCompChanged = true;
+		_prevBaseCompId = baseInfo.componentId;
+	}
 
-	// copy image & process OR copy ledColors from muxer
-	Image<ColorRgb> image = priorityInfo.image;
+	// process image OR copy ledColors from muxer
+	const int64_t mapStart = LatencyTracer::now();
+	const Image<ColorRgb>& image = baseInfo.image;
 	if(image.size() > 3)
 	{
 		emit currentImage(image);
 		// disable the black border detector for effects and ledmapping to 0
-		if(compChanged)
+		if(baseCompChanged)
 		{
-			_imageProcessor->setBlackbarDetectDisable((_prevCompId == hyperion::COMP_EFFECT));
-			_imageProcessor->setHardLedMappingType((_prevCompId == hyperion::COMP_EFFECT) ? 0 : -1);
+			_imageProcessor->setBlackbarDetectDisable((_prevBaseCompId == hyperion::COMP_EFFECT));
+			_imageProcessor->setHardLedMappingType((_prevBaseCompId == hyperion::COMP_EFFECT) ? 0 : -1);
 		}
 		_imageProcessor->process(image, _ledBuffer);
 	}
 	else
 	{
-		_ledBuffer = priorityInfo.ledColors;
+		_ledBuffer = baseInfo.ledColors;
 	}
+
+	// blend the higher layers over the base layer
+	for (int i = layers.size() - 2; i >= 0; --i)
+	{
+		const PriorityMuxer::InputInfo& layerInfo = _muxer.getInputInfo(layers.at(i));
+		if (layerInfo.image.size() > 3)
+			_compositor->blend(layerInfo.image, _ledBuffer);
+		else
+			_compositor->blend(layerInfo.ledColors, _ledBuffer);
+	}
+
+	LatencyTracer::record(LatencyTracer::MAP, LatencyTracer::now() - mapStart);
+
 	// copy rawLedColors before adjustments
 	_rawLedBuffer = _ledBuffer;
 
+	// multicast subscribers apply their own adjustments
+	_messageForwarder->publishLedColors(_rawLedBuffer);
+
 	// apply adjustments
+	const int64_t adjustStart = LatencyTracer::now();
 	if(compChanged)
 		_raw2ledAdjustment->setBacklightEnabled((_prevCompId != hyperion::COMP_COLOR && _prevCompId != hyperion::COMP_EFFECT));
 	_raw2ledAdjustment->applyAdjustment(_ledBuffer);
@@ -688,6 +748,7 @@ void Hyperion::update()
 	{
 		_ledBuffer.resize(_hwLedCount, ColorRgb::BLACK);
 	}
+	LatencyTracer::record(LatencyTracer::ADJUST, LatencyTracer::now() - adjustStart);
 
 	// Write the data to the device
 	if (_device->enabled())
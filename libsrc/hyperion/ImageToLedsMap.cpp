@@ -8,7 +8,8 @@ ImageToLedsMap::ImageToLedsMap(
 		const unsigned horizontalBorder,
 		const unsigned verticalBorder,
 		const std::vector<Led>& leds)
-	: _width(width)
+	: _log(Logger::getInstance("HYPERION"))
+	, _width(width)
 	, _height(height)
 	, _horizontalBorder(horizontalBorder)
 	, _verticalBorder(verticalBorder)
@@ -4,6 +4,8 @@
 
 #include "LinearColorSmoothing.h"
 #include <hyperion/Hyperion.h>
+#include <utils/LatencyTracer.h>
+#include <utils/MetricsRegistry.h>
 
 #include <cmath>
 
@@ -25,6 +27,9 @@ LinearColorSmoothing::LinearColorSmoothing( LedDevice * ledDevice, const QJsonDo
 {
 	Debug(_log, "Instance created");
 
+	// the writes only set the target colors, the device write is traced
+	_traceLatency = false;
+
 	// set initial state to true, as LedDevice::enabled() is true by default
 	_hyperion->getComponentRegister().componentStateChanged(hyperion::COMP_SMOOTHING, true);
 
@@ -107,6 +112,7 @@ int LinearColorSmoothing::switchOff()
 
 void LinearColorSmoothing::updateLeds()
 {
+	const int64_t smoothStart = LatencyTracer::now();
 	int64_t now = QDateTime::currentMSecsSinceEpoch();
 	int deltaTime = _targetTime - now;
 
@@ -115,6 +121,7 @@ void LinearColorSmoothing::updateLeds()
 		memcpy(_previousValues.data(), _targetValues.data(), _targetValues.size() * sizeof(ColorRgb));
 		_previousTime = now;
 
+		LatencyTracer::record(LatencyTracer::SMOOTH, LatencyTracer::now() - smoothStart);
 		queueColors(_previousValues);
 		_writeToLedsEnable = _continuousOutput;
 	}
@@ -140,6 +147,7 @@ void LinearColorSmoothing::updateLeds()
 		}
 		_previousTime = now;
 
+		LatencyTracer::record(LatencyTracer::SMOOTH, LatencyTracer::now() - smoothStart);
 		queueColors(_previousValues);
 	}
 }
@@ -171,6 +179,7 @@ void LinearColorSmoothing::queueColors(const std::vector<ColorRgb> & ledColors)
 				_outputQueue.pop_front();
 			}
 		}
+		MetricsRegistry::set(MetricsRegistry::SMOOTHING_QUEUE_DEPTH, int64_t(_outputQueue.size()));
 	}
 }
 
@@ -1,7 +1,10 @@
 // STL includes
 #include <stdexcept>
 
+#include <QDateTime>
+
 #include <hyperion/MessageForwarder.h>
+#include <hyperion/MulticastPublisher.h>
 
 #include <utils/Logger.h>
 #include <hyperion/Hyperion.h>
@@ -10,10 +13,14 @@ MessageForwarder::MessageForwarder(Hyperion* hyperion, const QJsonDocument & con
 	: QObject()
 	, _hyperion(hyperion)
 	, _log(Logger::getInstance("NETFORWARDER"))
+	, _multicastPublisher(new MulticastPublisher(this))
+	, _forwarderEnabled(false)
 {
 	handleSettingsUpdate(settings::NETFORWARD, config);
 	// get settings updates
 	connect(_hyperion, &Hyperion::settingsChanged, this, &MessageForwarder::handleSettingsUpdate);
+	// get component state changes
+	connect(&_hyperion->getComponentRegister(), &ComponentRegister::updatedComponentState, this, &MessageForwarder::componentStateChanged);
 }
 
 MessageForwarder::~MessageForwarder()
@@ -46,8 +53,12 @@ void MessageForwarder::handleSettingsUpdate(const settings::type& type, const QJ
 				addProtoSlave(entry.toString());
 			}
 		}
-		InfoIf(obj["enable"].toBool(true), _log, "Forward now to json targets '%s' and proto targets '%s'", QSTRING_CSTR(_jsonSlaves.join(", ")), QSTRING_CSTR(_protoSlaves.join(", ")))
+
+		setMulticastTarget(obj["multicast"].toString(""));
+
+		InfoIf(obj["enable"].toBool(true), _log, "Forward now to json targets '%s', proto targets '%s' and multicast group '%s'", QSTRING_CSTR(_jsonSlaves.join(", ")), QSTRING_CSTR(_protoSlaves.join(", ")), QSTRING_CSTR(_multicastPublisher->getTarget()))
 		// update comp state
+		_forwarderEnabled = obj["enable"].toBool(true);
 		_hyperion->getComponentRegister().componentStateChanged(hyperion::COMP_FORWARDER, obj["enable"].toBool(true));
 	}
 }
@@ -107,6 +118,44 @@ void MessageForwarder::addProtoSlave(QString slave)
 	_protoSlaves << slave;
 }
 
+void MessageForwarder::setMulticastTarget(const QString& target)
+{
+	if (!_multicastPublisher->setTarget(target) || target.isEmpty())
+	{
+		return;
+	}
+
+	// verify loop with udplistener, it would show the published frames again
+	const QJsonObject& obj = _hyperion->getSetting(settings::UDPLISTENER).object();
+	const QStringList parts = target.split(":");
+	if (obj["enable"].toBool(false) && QHostAddress(obj["address"].toString()) == QHostAddress(parts[0]) && parts[1].toInt() == obj["port"].toInt())
+	{
+		Error(_log, "Loop between UDPListener and Forwarder! (%s)",QSTRING_CSTR(target));
+		_multicastPublisher->setTarget("");
+	}
+}
+
+QString MessageForwarder::getMulticastTarget() const
+{
+	return _multicastPublisher->getTarget();
+}
+
+void MessageForwarder::publishLedColors(const std::vector<ColorRgb>& ledColors)
+{
+	if (_forwarderEnabled)
+	{
+		_multicastPublisher->publish(ledColors);
+	}
+}
+
+void MessageForwarder::componentStateChanged(const hyperion::Components component, bool enable)
+{
+	if (component == hyperion::COMP_FORWARDER)
+	{
+		_forwarderEnabled = enable;
+	}
+}
+
 bool MessageForwarder::protoForwardingEnabled()
 {
 	return ! _protoSlaves.empty();
@@ -116,3 +165,53 @@ bool MessageForwarder::jsonForwardingEnabled()
 {
 	return ! _jsonSlaves.empty();
 }
+
+void MessageForwarder::addProtoStatistics(const QString& target, qint64 bytesWritten, qint64 cpuNs, bool skipped)
+{
+	ProtoStatistics& stats = _protoStatistics[target];
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	skipped ? ++stats.skipped : ++stats.frames;
+	stats.bytes  = bytesWritten;
+	stats.cpuNs += cpuNs;
+
+	if (stats.windowStart == 0)
+	{
+		stats.windowStart = now;
+	}
+	else if (now - stats.windowStart >= 1000)
+	{
+		const qint64 frames = stats.frames - stats.windowFrames;
+		stats.bytesPerSecond = 1000.0 * (stats.bytes - stats.windowBytes) / (now - stats.windowStart);
+		stats.cpuUsPerFrame  = (frames > 0) ? (stats.cpuNs - stats.windowCpuNs) / 1000.0 / frames : 0;
+
+		stats.windowStart  = now;
+		stats.windowFrames = stats.frames;
+		stats.windowBytes  = stats.bytes;
+		stats.windowCpuNs  = stats.cpuNs;
+	}
+}
+
+QJsonArray MessageForwarder::getProtoStatistics() const
+{
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	QJsonArray targets;
+	for (auto it = _protoStatistics.constBegin(); it != _protoStatistics.constEnd(); ++it)
+	{
+		const ProtoStatistics& stats = it.value();
+
+		// the rates of a target which hasn't got frames for a while are outdated
+		const bool active = now - stats.windowStart < 2000;
+
+		QJsonObject target;
+		target["target"]         = it.key();
+		target["frames"]         = stats.frames;
+		target["skipped"]        = stats.skipped;
+		target["bytes"]          = stats.bytes;
+		target["bytesPerSecond"] = active ? stats.bytesPerSecond : 0.0;
+		target["cpuUsPerFrame"]  = active ? stats.cpuUsPerFrame : 0.0;
+		targets.append(target);
+	}
+	return targets;
+}
@@ -0,0 +1,111 @@
+// STL includes
+#include <cstring>
+#include <random>
+
+// Qt includes
+#include <QUdpSocket>
+#include <QDateTime>
+#include <QStringList>
+
+// Hyperion includes
+#include <hyperion/MulticastPublisher.h>
+
+namespace {
+	inline void writeUInt16(char* data, quint16 value)
+	{
+		data[0] = char(value >> 8);
+		data[1] = char(value);
+	}
+
+	inline void writeUInt32(char* data, quint32 value)
+	{
+		data[0] = char(value >> 24);
+		data[1] = char(value >> 16);
+		data[2] = char(value >> 8);
+		data[3] = char(value);
+	}
+}
+
+MulticastPublisher::MulticastPublisher(QObject* parent)
+	: QObject(parent)
+	, _log(Logger::getInstance("NETFORWARDER"))
+	, _socket(new QUdpSocket(this))
+	, _group()
+	, _port(0)
+	, _session(quint32(std::random_device()()) ^ quint32(QDateTime::currentMSecsSinceEpoch()))
+	, _sequence(0)
+	, _datagram(MULTICAST_HEADER_SIZE + MULTICAST_FRAGMENT_SIZE, 0)
+{
+	char* header = _datagram.data();
+	header[0] = MULTICAST_MAGIC_0;
+	header[1] = MULTICAST_MAGIC_1;
+	header[2] = MULTICAST_VERSION;
+	header[3] = 0;
+	writeUInt32(header + 4, _session);
+}
+
+MulticastPublisher::~MulticastPublisher()
+{
+}
+
+bool MulticastPublisher::setTarget(const QString& target)
+{
+	_group.clear();
+	_port = 0;
+
+	if (target.isEmpty())
+	{
+		return true;
+	}
+
+	const QStringList parts = target.split(":");
+	bool ok = parts.size() == 2;
+	const quint16 port = ok ? parts[1].toUShort(&ok) : 0;
+	const QHostAddress group(parts[0]);
+	if (!ok || port == 0 || !group.isInSubnet(QHostAddress::parseSubnet("224.0.0.0/4")))
+	{
+		Error(_log, "Unable to parse multicast group (%s)", QSTRING_CSTR(target));
+		return false;
+	}
+
+	_group = group;
+	_port = port;
+	return true;
+}
+
+QString MulticastPublisher::getTarget() const
+{
+	return enabled() ? QString("%1:%2").arg(_group.toString()).arg(_port) : QString();
+}
+
+void MulticastPublisher::publish(const std::vector<ColorRgb>& ledColors)
+{
+	if (!enabled() || ledColors.empty())
+	{
+		return;
+	}
+
+	const quint32 frameSize = quint32(ledColors.size() * sizeof(ColorRgb));
+	const quint32 fragmentCount = (frameSize + MULTICAST_FRAGMENT_SIZE - 1) / MULTICAST_FRAGMENT_SIZE;
+	if (fragmentCount > 0xFFFF)
+	{
+		return;
+	}
+
+	const char* frame = reinterpret_cast<const char*>(ledColors.data());
+	char* header = _datagram.data();
+	writeUInt32(header + 8, _sequence);
+	writeUInt16(header + 14, quint16(fragmentCount));
+	writeUInt32(header + 16, frameSize);
+
+	for (quint32 index = 0; index < fragmentCount; ++index)
+	{
+		const quint32 offset = index * MULTICAST_FRAGMENT_SIZE;
+		const quint32 length = qMin(frameSize - offset, quint32(MULTICAST_FRAGMENT_SIZE));
+
+		writeUInt16(header + 12, quint16(index));
+		memcpy(header + MULTICAST_HEADER_SIZE, frame + offset, length);
+		_socket->writeDatagram(header, MULTICAST_HEADER_SIZE + length, _group, _port);
+	}
+	++_sequence;
+}
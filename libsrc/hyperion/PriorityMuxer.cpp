@@ -11,18 +11,48 @@
 
 // utils
 #include <utils/Logger.h>
+#include <utils/MetricsRegistry.h>
 
 const int PriorityMuxer::LOWEST_PRIORITY = std::numeric_limits<uint8_t>::max();
 
+static inline int countTrailingZeros(quint64 value)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	int count = 0;
+	for (; !(value & 1); value >>= 1)
+		++count;
+	return count;
+#endif
+}
+
+int PriorityMuxer::PriorityBitmap::next(const int from) const
+{
+	for (int index = qMax(from, 0); index < 256; index = (index | 63) + 1)
+	{
+		const quint64 bits = _words[index >> 6] >> (index & 63);
+		if (bits)
+			return index + countTrailingZeros(bits);
+	}
+	return -1;
+}
+
 PriorityMuxer::PriorityMuxer(int ledCount)
 	: QObject()
 	, _log(Logger::getInstance("HYPERION"))
 	, _currentPriority(PriorityMuxer::LOWEST_PRIORITY)
 	, _manualSelectedPriority(256)
-	, _activeInputs()
+	, _inputs()
+	, _registered()
+	, _active()
+	, _timeRunning()
+	, _timeouts()
+	, _queuedTimeouts()
 	, _lowestPriorityInfo()
 	, _sourceAutoSelectEnabled(true)
-	, _updateTimer(new QTimer(this))
+	, _enabled(true)
+	, _timeoutTimer(new QTimer(this))
 	, _timer(new QTimer(this))
 	, _blockTimer(new QTimer(this))
 {
@@ -34,7 +64,9 @@ PriorityMuxer::PriorityMuxer(int ledCount)
 	_lowestPriorityInfo.origin         = "System";
 	_lowestPriorityInfo.owner          = "";
 
-	_activeInputs[PriorityMuxer::LOWEST_PRIORITY] = _lowestPriorityInfo;
+	_inputs[PriorityMuxer::LOWEST_PRIORITY] = _lowestPriorityInfo;
+	_registered.set(PriorityMuxer::LOWEST_PRIORITY);
+	_active.set(PriorityMuxer::LOWEST_PRIORITY);
 
 	// adapt to 1s interval for COLOR and EFFECT timeouts > -1
 	connect(_timer, &QTimer::timeout, this, &PriorityMuxer::timeTrigger);
@@ -44,11 +76,10 @@ PriorityMuxer::PriorityMuxer(int ledCount)
 	connect(this, &PriorityMuxer::timeRunner, this, &PriorityMuxer::prioritiesChanged);
 	connect(this, &PriorityMuxer::signalTimeTrigger, this, &PriorityMuxer::timeTrigger);
 
-	// start muxer timer
-	connect(_updateTimer, &QTimer::timeout, this, &PriorityMuxer::setCurrentTime);
-	_updateTimer->setInterval(250);
-	_updateTimer->start();
-	InputInfo ninfo;
+	// the muxer timer is armed for the earliest timeout, idle it doesn't wake up
+	connect(_timeoutTimer, &QTimer::timeout, this, &PriorityMuxer::setCurrentTime);
+	_timeoutTimer->setSingleShot(true);
+	_timeoutTimer->setTimerType(Qt::PreciseTimer);
 }
 
 PriorityMuxer::~PriorityMuxer()
@@ -57,7 +88,16 @@ PriorityMuxer::~PriorityMuxer()
 
 void PriorityMuxer::setEnable(const bool& enable)
 {
-	enable ? _updateTimer->start() : _updateTimer->stop();
+	_enabled = enable;
+	if (enable)
+	{
+		// clear the timeouts which passed meanwhile, rearms the timer
+		setCurrentTime();
+	}
+	else
+	{
+		_timeoutTimer->stop();
+	}
 }
 
 bool PriorityMuxer::setSourceAutoSelectEnabled(const bool& enable, const bool& update)
@@ -65,7 +105,7 @@ bool PriorityMuxer::setSourceAutoSelectEnabled(const bool& enable, const bool& u
 	if(_sourceAutoSelectEnabled != enable)
 	{
 		// on disable we need to make sure the last priority call to setPriority is still valid
-		if(!enable && !_activeInputs.contains(_manualSelectedPriority))
+		if(!enable && !_registered.test(_manualSelectedPriority))
 		{
 			Warning(_log, "Can't disable auto selection, as the last manual selected priority (%d) is no longer available", _manualSelectedPriority);
 			return false;
@@ -86,7 +126,7 @@ bool PriorityMuxer::setSourceAutoSelectEnabled(const bool& enable, const bool& u
 
 bool PriorityMuxer::setPriority(const uint8_t priority)
 {
-	if(_activeInputs.contains(priority))
+	if(_registered.test(priority))
 	{
 		_manualSelectedPriority = priority;
 		// update auto select state -> update _currentPriority
@@ -98,13 +138,13 @@ bool PriorityMuxer::setPriority(const uint8_t priority)
 
 void PriorityMuxer::updateLedColorsLength(const int& ledCount)
 {
-	for (auto infoIt = _activeInputs.begin(); infoIt != _activeInputs.end();)
+	for (int priority = _registered.next(0); priority != -1; priority = _registered.next(priority + 1))
 	{
-		if (infoIt->ledColors.size() >= 1)
+		std::vector<ColorRgb>& ledColors = _inputs[priority].ledColors;
+		if (ledColors.size() >= 1)
 		{
-			infoIt->ledColors.resize(ledCount, infoIt->ledColors.at(0));
+			ledColors.resize(ledCount, ledColors.at(0));
 		}
-		++infoIt;
 	}
 }
 
@@ -115,44 +155,70 @@ int PriorityMuxer::getCurrentPriority() const
 
 QList<int> PriorityMuxer::getPriorities() const
 {
-	return _activeInputs.keys();
+	QList<int> priorities;
+	for (int priority = _registered.next(0); priority != -1; priority = _registered.next(priority + 1))
+	{
+		priorities << priority;
+	}
+	return priorities;
+}
+
+QList<int> PriorityMuxer::getVisiblePriorities(const int count) const
+{
+	QList<int> priorities;
+	priorities << _currentPriority;
+
+	// walk the active inputs from the current priority to the lower ones, skip the black of the lowest priority
+	for (int priority = _active.next(_currentPriority + 1); priority != -1 && priority < PriorityMuxer::LOWEST_PRIORITY && priorities.size() < count; priority = _active.next(priority + 1))
+	{
+		priorities << priority;
+	}
+	return priorities;
 }
 
 bool PriorityMuxer::hasPriority(const int priority) const
 {
-	return (priority == PriorityMuxer::LOWEST_PRIORITY) ? true : _activeInputs.contains(priority);
+	return (priority == PriorityMuxer::LOWEST_PRIORITY) ? true : _registered.test(priority);
 }
 
-const PriorityMuxer::InputInfo PriorityMuxer::getInputInfo(const int priority) const
+const PriorityMuxer::InputInfo& PriorityMuxer::getInputInfo(const int priority) const
 {
-	auto elemIt = _activeInputs.find(priority);
-	if (elemIt == _activeInputs.end())
+	if (_registered.test(priority))
 	{
-		elemIt = _activeInputs.find(PriorityMuxer::LOWEST_PRIORITY);
-		if (elemIt == _activeInputs.end())
-		{
-			// fallback
-			return _lowestPriorityInfo;
-		}
+		return _inputs[priority];
 	}
-	return elemIt.value();
+	if (_registered.test(PriorityMuxer::LOWEST_PRIORITY))
+	{
+		return _inputs[PriorityMuxer::LOWEST_PRIORITY];
+	}
+	// fallback
+	return _lowestPriorityInfo;
 }
 
 void PriorityMuxer::registerInput(const int priority, const hyperion::Components& component, const QString& origin, const QString& owner, unsigned smooth_cfg)
 {
+	if (priority < 0 || priority > PriorityMuxer::LOWEST_PRIORITY)
+	{
+		Error(_log,"registerInput() with invalid priority %d from '%s'", priority, QSTRING_CSTR(origin));
+		return;
+	}
+
 	// detect new registers
 	bool newInput = false;
-	if(!_activeInputs.contains(priority))
+	if(!_registered.test(priority))
 		newInput = true;
 
-	InputInfo& input     = _activeInputs[priority];
+	InputInfo& input     = _inputs[priority];
 	input.priority       = priority;
-	input.timeoutTime_ms = newInput ? -100 : input.timeoutTime_ms;
 	input.componentId    = component;
 	input.origin         = origin;
 	input.smooth_cfg     = smooth_cfg;
 	input.owner          = owner;
 
+	_registered.set(priority);
+	// new inputs are inactive, existing ones may have changed their component
+	setTimeout(input, newInput ? -100 : input.timeoutTime_ms);
+
 	if(newInput)
 	{
 		Debug(_log,"Register new input '%s/%s' with priority %d as inactive", QSTRING_CSTR(origin), hyperion::componentToIdString(component), priority);
@@ -164,7 +230,7 @@ void PriorityMuxer::registerInput(const int priority, const hyperion::Components
 
 const bool PriorityMuxer::setInput(const int priority, const std::vector<ColorRgb>& ledColors, int64_t timeout_ms)
 {
-	if(!_activeInputs.contains(priority))
+	if(!_registered.test(priority))
 	{
 		Error(_log,"setInput() used without registerInput() for priority '%d', probably the priority reached timeout",priority);
 		return false;
@@ -174,23 +240,16 @@ const bool PriorityMuxer::setInput(const int priority, const std::vector<ColorRg
 	if(timeout_ms > 0)
 		timeout_ms = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
 
-	InputInfo& input     = _activeInputs[priority];
-	// detect active <-> inactive changes
-	bool activeChange = false;
-	bool active = true;
-	if(input.timeoutTime_ms == -100 && timeout_ms != -100)
-	{
-		activeChange = true;
-	}
-	else if(timeout_ms == -100 && input.timeoutTime_ms != -100)
-	{
-		active = false;
-		activeChange = true;
-	}
-	// update input
-	input.timeoutTime_ms = timeout_ms;
+	InputInfo& input     = _inputs[priority];
+	// update input, detect active <-> inactive changes
+	const bool activeChange = setTimeout(input, timeout_ms);
+	const bool active = timeout_ms != -100;
 	input.ledColors      = ledColors;
 
+	// count the frame, inactive states carry none
+	if(active)
+		MetricsRegistry::addPriorityFrame(priority);
+
 	// emit active change
 	if(activeChange)
 	{
@@ -203,7 +262,7 @@ const bool PriorityMuxer::setInput(const int priority, const std::vector<ColorRg
 
 const bool PriorityMuxer::setInputImage(const int priority, const Image<ColorRgb>& image, int64_t timeout_ms)
 {
-	if(!_activeInputs.contains(priority))
+	if(!_registered.test(priority))
 	{
 		Error(_log,"setInputImage() used without registerInput() for priority '%d', probably the priority reached timeout",priority);
 		return false;
@@ -213,23 +272,16 @@ const bool PriorityMuxer::setInputImage(const int priority, const Image<ColorRgb
 	if(timeout_ms > 0)
 		timeout_ms = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
 
-	InputInfo& input     = _activeInputs[priority];
-	// detect active <-> inactive changes
-	bool activeChange = false;
-	bool active = true;
-	if(input.timeoutTime_ms == -100 && timeout_ms != -100)
-	{
-		activeChange = true;
-	}
-	else if(timeout_ms == -100 && input.timeoutTime_ms != -100)
-	{
-		active = false;
-		activeChange = true;
-	}
-	// update input
-	input.timeoutTime_ms = timeout_ms;
+	InputInfo& input     = _inputs[priority];
+	// update input, detect active <-> inactive changes
+	const bool activeChange = setTimeout(input, timeout_ms);
+	const bool active = timeout_ms != -100;
 	input.image          = image;
 
+	// count the frame, inactive states carry none
+	if(active)
+		MetricsRegistry::addPriorityFrame(priority);
+
 	// emit active change
 	if(activeChange)
 	{
@@ -248,8 +300,9 @@ const bool PriorityMuxer::setInputInactive(const quint8& priority)
 
 const bool PriorityMuxer::clearInput(const uint8_t priority)
 {
-	if (priority < PriorityMuxer::LOWEST_PRIORITY && _activeInputs.remove(priority))
+	if (priority < PriorityMuxer::LOWEST_PRIORITY && _registered.test(priority))
 	{
+		removeInput(priority);
 		Debug(_log,"Removed source priority %d",priority);
 		// on clear success update _currentPriority
 		setCurrentTime();
@@ -264,18 +317,24 @@ void PriorityMuxer::clearAll(bool forceClearAll)
 {
 	if (forceClearAll)
 	{
-		_activeInputs.clear();
+		for (int priority = _registered.next(0); priority != -1; priority = _registered.next(priority + 1))
+		{
+			removeInput(priority);
+		}
+		_timeouts = decltype(_timeouts)();
 		_currentPriority = PriorityMuxer::LOWEST_PRIORITY;
-		_activeInputs[_currentPriority] = _lowestPriorityInfo;
+		_inputs[_currentPriority] = _lowestPriorityInfo;
+		_registered.set(_currentPriority);
+		_active.set(_currentPriority);
 	}
 	else
 	{
-		for(auto key : _activeInputs.keys())
+		for (int priority = _registered.next(0); priority != -1; priority = _registered.next(priority + 1))
 		{
-			const InputInfo info = getInputInfo(key);
-			if ((info.componentId == hyperion::COMP_COLOR || info.componentId == hyperion::COMP_EFFECT) && key < PriorityMuxer::LOWEST_PRIORITY-1)
+			const InputInfo& info = _inputs[priority];
+			if ((info.componentId == hyperion::COMP_COLOR || info.componentId == hyperion::COMP_EFFECT) && priority < PriorityMuxer::LOWEST_PRIORITY-1)
 			{
-				clearInput(key);
+				clearInput(priority);
 			}
 		}
 	}
@@ -284,36 +343,52 @@ void PriorityMuxer::clearAll(bool forceClearAll)
 void PriorityMuxer::setCurrentTime(void)
 {
 	const int64_t now = QDateTime::currentMSecsSinceEpoch();
-	int newPriority = PriorityMuxer::LOWEST_PRIORITY;
 
-	for (auto infoIt = _activeInputs.begin(); infoIt != _activeInputs.end();)
+	// pop the due timeouts, entries of inputs which have been updated or removed meanwhile are outdated
+	while (!_timeouts.empty() && _timeouts.top().first <= now)
 	{
-		if (infoIt->timeoutTime_ms > 0 && infoIt->timeoutTime_ms <= now)
+		const Timeout timeout = _timeouts.top();
+		_timeouts.pop();
+
+		const int priority = timeout.second;
+		if (_queuedTimeouts[priority] != timeout.first)
+			continue;
+
+		_queuedTimeouts[priority] = 0;
+		if (!_registered.test(priority))
+			continue;
+
+		const int64_t timeoutTime = _inputs[priority].timeoutTime_ms;
+		if (timeoutTime > 0 && timeoutTime <= now)
 		{
-			quint8 tPrio = infoIt->priority;
-			infoIt = _activeInputs.erase(infoIt);
-			Debug(_log,"Timeout clear for priority %d",tPrio);
-			emit priorityChanged(tPrio, false);
+			removeInput(priority);
+			Debug(_log,"Timeout clear for priority %d",priority);
+			emit priorityChanged(priority, false);
 			emit prioritiesChanged();
 		}
-		else
+		else if (timeoutTime > 0)
 		{
-			// timeoutTime of -100 is awaiting data (inactive); skip
-			if(infoIt->timeoutTime_ms >= -1)
-				newPriority = qMin(newPriority, infoIt->priority);
-
-			// call timeTrigger when effect or color is running with timeout > -1, blacklist prio 255
-			if(infoIt->priority < 254 && infoIt->timeoutTime_ms > -1 && (infoIt->componentId == hyperion::COMP_EFFECT || infoIt->componentId == hyperion::COMP_COLOR))
-			{
-				emit signalTimeTrigger(); // as signal to prevent Threading issues
-			}
-			++infoIt;
+			// the timeout has been extended
+			_queuedTimeouts[priority] = timeoutTime;
+			_timeouts.push(Timeout(timeoutTime, priority));
 		}
 	}
+
+	// timeoutTime of -100 is awaiting data (inactive); not in _active
+	int newPriority = _active.next(0);
+	if (newPriority == -1)
+		newPriority = PriorityMuxer::LOWEST_PRIORITY;
+
+	// call timeTrigger when effect or color is running with timeout > -1, blacklist prio 255
+	if (_timeRunning.any())
+	{
+		emit signalTimeTrigger(); // as signal to prevent Threading issues
+	}
+
 	// eval if manual selected prio is still available
 	if(!_sourceAutoSelectEnabled)
 	{
-		if(_activeInputs.contains(_manualSelectedPriority))
+		if(_registered.test(_manualSelectedPriority))
 		{
 			newPriority = _manualSelectedPriority;
 		}
@@ -337,6 +412,61 @@ void PriorityMuxer::setCurrentTime(void)
 		emit visiblePriorityChanged(newPriority);
 		emit prioritiesChanged();
 	}
+
+	scheduleTimeout();
+}
+
+bool PriorityMuxer::setTimeout(InputInfo& input, const int64_t timeout_ms)
+{
+	const int priority = input.priority;
+	if (priority < 0 || priority > PriorityMuxer::LOWEST_PRIORITY)
+	{
+		Error(_log,"setTimeout() with invalid priority %d", priority);
+		return false;
+	}
+
+	const bool activeChange = (input.timeoutTime_ms == -100) != (timeout_ms == -100);
+	input.timeoutTime_ms = timeout_ms;
+
+	if (timeout_ms >= -1)
+		_active.set(priority);
+	else
+		_active.reset(priority);
+
+	if (priority < 254 && timeout_ms > -1 && (input.componentId == hyperion::COMP_EFFECT || input.componentId == hyperion::COMP_COLOR))
+		_timeRunning.set(priority);
+	else
+		_timeRunning.reset(priority);
+
+	// a later timeout keeps the queued one, it's queued again when the earlier one is due
+	if (timeout_ms > 0 && (_queuedTimeouts[priority] <= 0 || timeout_ms < _queuedTimeouts[priority]))
+	{
+		_queuedTimeouts[priority] = timeout_ms;
+		_timeouts.push(Timeout(timeout_ms, priority));
+		scheduleTimeout();
+	}
+	return activeChange;
+}
+
+void PriorityMuxer::removeInput(const int priority)
+{
+	_inputs[priority] = InputInfo();
+	_registered.reset(priority);
+	_active.reset(priority);
+	_timeRunning.reset(priority);
+	_queuedTimeouts[priority] = 0;
+}
+
+void PriorityMuxer::scheduleTimeout()
+{
+	if (!_enabled || _timeouts.empty())
+	{
+		_timeoutTimer->stop();
+		return;
+	}
+
+	const int64_t remaining = _timeouts.top().first - QDateTime::currentMSecsSinceEpoch();
+	_timeoutTimer->start(int(qBound(int64_t(0), remaining, int64_t(std::numeric_limits<int>::max()))));
 }
 
 void PriorityMuxer::timeTrigger()
@@ -349,5 +479,9 @@ void PriorityMuxer::timeTrigger()
 	{
 		emit timeRunner();
 		_blockTimer->start(1000);
+
+		// keep the 1s interval while a color or effect with timeout is running
+		if (_timeRunning.any())
+			_timer->start(1000);
 	}
 }
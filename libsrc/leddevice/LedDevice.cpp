@@ -9,6 +9,8 @@
 
 #include "hyperion/Hyperion.h"
 #include <utils/JsonUtils.h>
+#include <utils/LatencyTracer.h>
+#include <utils/MetricsRegistry.h>
 
 LedDeviceRegistry LedDevice::_ledDeviceMap = LedDeviceRegistry();
 
@@ -21,6 +23,7 @@ LedDevice::LedDevice()
 	, _refresh_timer_interval(0)
 	, _last_write_time(QDateTime::currentMSecsSinceEpoch())
 	, _latchTime_ms(0)
+	, _traceLatency(true)
 	, _componentRegistered(false)
 	, _enabled(true)
 {
@@ -140,9 +143,21 @@ int LedDevice::setLedValues(const std::vector<ColorRgb>& ledValues)
 	if (_latchTime_ms == 0 || QDateTime::currentMSecsSinceEpoch()-_last_write_time >= _latchTime_ms)
 	{
 		_ledValues = ledValues;
+		const int64_t writeStart = LatencyTracer::now();
 		retval = write(ledValues);
+		if (_traceLatency)
+		{
+			LatencyTracer::record(LatencyTracer::WRITE, LatencyTracer::now() - writeStart);
+			LatencyTracer::markWrite();
+			if (retval < 0)
+				MetricsRegistry::add(MetricsRegistry::DEVICE_WRITE_ERRORS);
+		}
 		_last_write_time = QDateTime::currentMSecsSinceEpoch();
 	}
+	else if (_traceLatency)
+	{
+		MetricsRegistry::add(MetricsRegistry::DROPPED_LATCH);
+	}
 	//else Debug(_log, "latch %d", QDateTime::currentMSecsSinceEpoch()-_last_write_time);
 
 	return retval;
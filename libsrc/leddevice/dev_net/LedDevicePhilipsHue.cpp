@@ -4,6 +4,18 @@
 // qt includes
 #include <QtCore/qmath.h>
 #include <QNetworkReply>
+#include <QHostInfo>
+
+#ifdef HUE_STREAM_DTLS
+#include <QDtls>
+#include <QSslPreSharedKeyAuthenticator>
+#endif
+
+/* HueStream v1 message */
+#define HUE_STREAM_HEADER_SIZE 16
+#define HUE_STREAM_LIGHT_SIZE 9
+#define HUE_STREAM_COLORSPACE_RGB 0x00
+#define HUE_STREAM_DEVICE_LIGHT 0x00
 
 bool operator ==(CiColor p1, CiColor p2)
 {
@@ -199,12 +211,26 @@ void PhilipsHueBridge::resolveReply(QNetworkReply* reply)
 	reply->deleteLater();
 }
 
-void PhilipsHueBridge::post(QString route, QString content)
+QNetworkReply* PhilipsHueBridge::post(QString route, QString content)
 {
 	Debug(log, "Post %s: %s", QSTRING_CSTR(QString("http://IP/api/USR/%1").arg(route)), QSTRING_CSTR(content));
 
 	QNetworkRequest request(QString("http://%1/api/%2/%3").arg(host).arg(username).arg(route));
-	manager.put(request, content.toLatin1());
+	return manager.put(request, content.toLatin1());
+}
+
+QNetworkReply* PhilipsHueBridge::postDetached(QString route, QString content, int timeout_ms)
+{
+	Debug(log, "Post %s: %s", QSTRING_CSTR(QString("http://IP/api/USR/%1").arg(route)), QSTRING_CSTR(content));
+
+	QNetworkAccessManager* detachedManager = new QNetworkAccessManager();
+	QNetworkRequest request(QString("http://%1/api/%2/%3").arg(host).arg(username).arg(route));
+	QNetworkReply* reply = detachedManager->put(request, content.toLatin1());
+
+	// an aborted reply finishes as well
+	connect(reply, &QNetworkReply::finished, detachedManager, &QObject::deleteLater);
+	QTimer::singleShot(timeout_ms, reply, &QNetworkReply::abort);
+	return reply;
 }
 
 const std::set<QString> PhilipsHueLight::GAMUT_A_MODEL_IDS =
@@ -339,6 +365,228 @@ CiColorTriangle PhilipsHueLight::getColorSpace() const
 	return colorSpace;
 }
 
+unsigned int PhilipsHueLight::getId() const
+{
+	return id;
+}
+
+PhilipsHueStream::PhilipsHueStream(Logger* log, const QString& host, quint16 port, const QString& username, const QString& clientkey, int interval_ms)
+	: QObject()
+	, _log(log)
+	, _socket()
+	, _host(host)
+	, _port(port)
+	, _username(username)
+	, _clientkey(QByteArray::fromHex(clientkey.toLatin1()))
+	, _interval_ms(interval_ms)
+	, _message()
+	, _pending(false)
+	, _sequence(0)
+#ifdef HUE_STREAM_DTLS
+	, _dtls(nullptr)
+#endif
+{
+	// resolve host names once, the stream is addressed by ip
+	if (_host.isNull())
+	{
+		QHostInfo info = QHostInfo::fromName(host);
+		if (!info.addresses().isEmpty())
+			_host = info.addresses().first();
+	}
+
+	_paceTimer.setSingleShot(true);
+	connect(&_paceTimer, &QTimer::timeout, this, &PhilipsHueStream::sendMessage);
+}
+
+PhilipsHueStream::~PhilipsHueStream()
+{
+	close();
+}
+
+void PhilipsHueStream::open()
+{
+	if (_socket.state() != QAbstractSocket::BoundState && !_socket.bind())
+	{
+		Error(_log, "Stream: Could not bind local udp socket");
+		return;
+	}
+
+	if (_clientkey.isEmpty())
+	{
+		Warning(_log, "Stream: No clientkey provided, streaming unencrypted to %s:%d", QSTRING_CSTR(_host.toString()), _port);
+		return;
+	}
+
+#ifdef HUE_STREAM_DTLS
+	delete _dtls;
+	_dtls = new QDtls(QSslSocket::SslClientMode, this);
+
+	QSslConfiguration config = QSslConfiguration::defaultDtlsConfiguration();
+	config.setPeerVerifyMode(QSslSocket::VerifyNone);
+	config.setCiphers(QList<QSslCipher>() << QSslCipher("PSK-AES128-GCM-SHA256"));
+
+	_dtls->setPeer(_host, _port);
+	_dtls->setDtlsConfiguration(config);
+	connect(_dtls, &QDtls::pskRequired, this, &PhilipsHueStream::pskRequired);
+	connect(_dtls, &QDtls::handshakeTimeout, this, &PhilipsHueStream::handshakeTimeout);
+	connect(&_socket, &QUdpSocket::readyRead, this, &PhilipsHueStream::readPendingDatagrams, Qt::UniqueConnection);
+
+	Debug(_log, "Stream: Start DTLS handshake with %s:%d", QSTRING_CSTR(_host.toString()), _port);
+	if (!_dtls->doHandshake(&_socket))
+	{
+		Error(_log, "Stream: DTLS handshake failed: %s", QSTRING_CSTR(_dtls->dtlsErrorString()));
+	}
+#else
+	Error(_log, "Stream: Encrypted streaming requires Qt 5.12 or newer with SSL support");
+#endif
+}
+
+void PhilipsHueStream::close()
+{
+	// the last colors, e.g. black of switchOff(), may still wait for the stream interval
+	if (_pending)
+	{
+		sendMessage();
+	}
+	_paceTimer.stop();
+	_pending = false;
+
+#ifdef HUE_STREAM_DTLS
+	if (_dtls != nullptr)
+	{
+		if (_dtls->isConnectionEncrypted())
+			_dtls->shutdown(&_socket);
+
+		delete _dtls;
+		_dtls = nullptr;
+	}
+#endif
+	_socket.close();
+}
+
+bool PhilipsHueStream::isOpen() const
+{
+	if (_socket.state() != QAbstractSocket::BoundState)
+		return false;
+
+#ifdef HUE_STREAM_DTLS
+	if (!_clientkey.isEmpty())
+		return _dtls != nullptr && _dtls->isConnectionEncrypted();
+#endif
+	return _clientkey.isEmpty();
+}
+
+void PhilipsHueStream::buildMessage(QByteArray& message, uint8_t sequence, const std::vector<unsigned int>& lightIds, const std::vector<ColorRgb>& colors, float brightnessFactor)
+{
+	const size_t lightCount = qMin(lightIds.size(), colors.size());
+	message.resize(HUE_STREAM_HEADER_SIZE + HUE_STREAM_LIGHT_SIZE * lightCount);
+	uint8_t* data = reinterpret_cast<uint8_t*>(message.data());
+
+	// header: protocol name, version 1.0, sequence, reserved, color space, reserved
+	memcpy(data, "HueStream", 9);
+	data[9]  = 0x01;
+	data[10] = 0x00;
+	data[11] = sequence;
+	data[12] = 0x00;
+	data[13] = 0x00;
+	data[14] = HUE_STREAM_COLORSPACE_RGB;
+	data[15] = 0x00;
+
+	// per light: device type, id and 16 bit colors, all big endian
+	uint8_t* light = data + HUE_STREAM_HEADER_SIZE;
+	for (size_t idx = 0; idx < lightCount; ++idx, light += HUE_STREAM_LIGHT_SIZE)
+	{
+		const ColorRgb& color = colors[idx];
+		const uint16_t red   = uint16_t(qMin(65535.0f, color.red   * 257.0f * brightnessFactor));
+		const uint16_t green = uint16_t(qMin(65535.0f, color.green * 257.0f * brightnessFactor));
+		const uint16_t blue  = uint16_t(qMin(65535.0f, color.blue  * 257.0f * brightnessFactor));
+
+		light[0] = HUE_STREAM_DEVICE_LIGHT;
+		light[1] = (lightIds[idx] >> 8) & 0xFF;
+		light[2] = lightIds[idx] & 0xFF;
+		light[3] = red >> 8;
+		light[4] = red & 0xFF;
+		light[5] = green >> 8;
+		light[6] = green & 0xFF;
+		light[7] = blue >> 8;
+		light[8] = blue & 0xFF;
+	}
+}
+
+void PhilipsHueStream::setColors(const std::vector<unsigned int>& lightIds, const std::vector<ColorRgb>& colors, float brightnessFactor)
+{
+	// the sequence number is set on send, as frames might be merged
+	buildMessage(_message, 0, lightIds, colors, brightnessFactor);
+	_pending = true;
+
+	if (!_lastSent.isValid() || _lastSent.elapsed() >= _interval_ms)
+	{
+		sendMessage();
+	}
+	else if (!_paceTimer.isActive())
+	{
+		_paceTimer.start(_interval_ms - _lastSent.elapsed());
+	}
+}
+
+void PhilipsHueStream::sendMessage()
+{
+	if (!_pending || !isOpen())
+		return;
+
+	_message[11] = char(_sequence++);
+
+	qint64 written;
+#ifdef HUE_STREAM_DTLS
+	if (_dtls != nullptr)
+		written = _dtls->writeDatagramEncrypted(&_socket, _message);
+	else
+#endif
+		written = _socket.writeDatagram(_message, _host, _port);
+
+	WarningIf((written < 0), _log, "Stream: Error sending: %s", QSTRING_CSTR(_socket.errorString()));
+
+	_pending = false;
+	_lastSent.start();
+}
+
+#ifdef HUE_STREAM_DTLS
+void PhilipsHueStream::readPendingDatagrams()
+{
+	while (_socket.hasPendingDatagrams())
+	{
+		QByteArray datagram(_socket.pendingDatagramSize(), 0);
+		_socket.readDatagram(datagram.data(), datagram.size());
+
+		if (_dtls != nullptr && _dtls->handshakeState() == QDtls::HandshakeInProgress)
+		{
+			if (!_dtls->doHandshake(&_socket, datagram))
+			{
+				Error(_log, "Stream: DTLS handshake failed: %s", QSTRING_CSTR(_dtls->dtlsErrorString()));
+			}
+			else if (_dtls->isConnectionEncrypted())
+			{
+				Info(_log, "Stream: Connected to %s:%d", QSTRING_CSTR(_host.toString()), _port);
+			}
+		}
+	}
+}
+
+void PhilipsHueStream::pskRequired(QSslPreSharedKeyAuthenticator* authenticator)
+{
+	authenticator->setIdentity(_username.toLatin1());
+	authenticator->setPreSharedKey(_clientkey);
+}
+
+void PhilipsHueStream::handshakeTimeout()
+{
+	if (_dtls != nullptr && !_dtls->handleTimeout(&_socket))
+	{
+		Error(_log, "Stream: DTLS handshake timeout: %s", QSTRING_CSTR(_dtls->dtlsErrorString()));
+	}
+}
+#endif
+
 LedDevice* LedDevicePhilipsHue::construct(const QJsonObject &deviceConfig)
 {
 	return new LedDevicePhilipsHue(deviceConfig);
@@ -347,6 +595,9 @@ LedDevice* LedDevicePhilipsHue::construct(const QJsonObject &deviceConfig)
 LedDevicePhilipsHue::LedDevicePhilipsHue(const QJsonObject& deviceConfig)
 	: LedDevice()
 	, bridge(_log, deviceConfig["output"].toString(), deviceConfig["username"].toString())
+	, useEntertainmentApi(false)
+	, groupId(0)
+	, stream(nullptr)
 {
 	_deviceReady = init(deviceConfig);
 
@@ -357,6 +608,25 @@ LedDevicePhilipsHue::LedDevicePhilipsHue(const QJsonObject& deviceConfig)
 LedDevicePhilipsHue::~LedDevicePhilipsHue()
 {
 	switchOff();
+
+	if (stream != nullptr)
+	{
+		// closing the stream sends the pending black frame before the group stops streaming
+		delete stream;
+		stream = nullptr;
+
+		// the request of the bridge would be aborted together with the device, the bridge would remain in streaming mode
+		QNetworkReply* reply = setStreamActive(false, true);
+		Logger* log = _log;
+		const int group = groupId;
+		connect(reply, &QNetworkReply::finished, reply, [reply, log, group]()
+		{
+			if (reply->error() != QNetworkReply::NoError || reply->readAll().contains("\"error\""))
+			{
+				Warning(log, "Stream: deactivation of group %d not confirmed by the bridge", group);
+			}
+		});
+	}
 }
 
 bool LedDevicePhilipsHue::init(const QJsonObject &deviceConfig)
@@ -364,6 +634,8 @@ bool LedDevicePhilipsHue::init(const QJsonObject &deviceConfig)
 	switchOffOnBlack = deviceConfig["switchOffOnBlack"].toBool(true);
 	brightnessFactor = (float) deviceConfig["brightnessFactor"].toDouble(1.0);
 	transitionTime = deviceConfig["transitiontime"].toInt(1);
+	useEntertainmentApi = deviceConfig["useEntertainmentAPI"].toBool(false);
+	groupId = deviceConfig["groupId"].toInt(0);
 	QJsonArray lArray = deviceConfig["lightIds"].toArray();
 
 	QJsonObject newDC = deviceConfig;
@@ -376,8 +648,18 @@ bool LedDevicePhilipsHue::init(const QJsonObject &deviceConfig)
 		// get light info from bridge
 		bridge.bConnect();
 
-		// adapt latchTime to count of user lightIds (bridge 10Hz max overall)
-		newDC.insert("latchTime",QJsonValue(100*(int)lightIds.size()));
+		if (useEntertainmentApi)
+		{
+			// the stream paces itself and has to be refreshed, the bridge ends a stream after 10s without messages
+			stream = new PhilipsHueStream(_log, deviceConfig["output"].toString(), HUE_STREAM_PORT, deviceConfig["username"].toString(), deviceConfig["clientkey"].toString());
+			newDC.insert("latchTime", QJsonValue(0));
+			newDC.insert("rewriteTime", QJsonValue(deviceConfig["rewriteTime"].toInt(1000)));
+		}
+		else
+		{
+			// adapt latchTime to count of user lightIds (bridge 10Hz max overall)
+			newDC.insert("latchTime",QJsonValue(100*(int)lightIds.size()));
+		}
 	}
 	else
 	{
@@ -406,9 +688,44 @@ void LedDevicePhilipsHue::newLights(QMap<quint16, QJsonObject> map)
 				Error(_log,"Light id %d isn't used on this bridge", id);
 			}
 		}
+
+		if (stream != nullptr)
+		{
+			streamLightIds.clear();
+			for (const PhilipsHueLight& light : lights)
+			{
+				streamLightIds.push_back(light.getId());
+			}
+			// the bridge accepts the stream only once the group is active
+			QNetworkReply* reply = setStreamActive(true);
+			connect(reply, &QNetworkReply::finished, this, [this, reply]()
+			{
+				// the bridge answers with a list of success or error objects
+				const QByteArray response = reply->readAll();
+				if (reply->error() != QNetworkReply::NoError || response.contains("\"error\""))
+				{
+					Error(_log, "Stream: activation of group %d failed: %s", groupId,
+						(reply->error() != QNetworkReply::NoError) ? QSTRING_CSTR(reply->errorString()) : response.constData());
+					return;
+				}
+
+				// the device might have been disabled meanwhile
+				if (stream != nullptr && !lights.empty())
+				{
+					stream->open();
+				}
+			});
+		}
 	}
 }
 
+QNetworkReply* LedDevicePhilipsHue::setStreamActive(bool active, bool detached)
+{
+	const QString route = QString("groups/%1").arg(groupId);
+	const QString content = QString("{ \"stream\": { \"active\": %1 } }").arg(active ? "true" : "false");
+	return detached ? bridge.postDetached(route, content, HUE_STREAM_DEACTIVATE_TIMEOUT) : bridge.post(route, content);
+}
+
 int LedDevicePhilipsHue::write(const std::vector<ColorRgb> & ledValues)
 {
 	// lights will be empty sometimes
@@ -421,6 +738,13 @@ int LedDevicePhilipsHue::write(const std::vector<ColorRgb> & ledValues)
 		return -1;
 	}
 
+	// all lights with a single message
+	if (stream != nullptr)
+	{
+		stream->setColors(streamLightIds, ledValues, brightnessFactor);
+		return 0;
+	}
+
 	// Iterate through lights and set colors.
 	unsigned int idx = 0;
 	for (PhilipsHueLight& light : lights)
@@ -453,7 +777,16 @@ int LedDevicePhilipsHue::write(const std::vector<ColorRgb> & ledValues)
 void LedDevicePhilipsHue::stateChanged(bool newState)
 {
 	if(newState)
+	{
 		bridge.bConnect();
+	}
 	else
+	{
 		lights.clear();
+		if (stream != nullptr)
+		{
+			stream->close();
+			setStreamActive(false);
+		}
+	}
 }
@@ -6,6 +6,17 @@
 // Qt includes
 #include <QNetworkAccessManager>
 #include <QTimer>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QByteArray>
+
+// DTLS is required by the bridge for entertainment streaming, available since Qt 5.12
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0) && !defined(QT_NO_SSL)
+#define HUE_STREAM_DTLS
+class QDtls;
+class QSslPreSharedKeyAuthenticator;
+#endif
 
 // Leddevice includes
 #include <leddevice/LedDevice.h>
@@ -129,7 +140,23 @@ public:
 	///
 	/// @param content the content of the POST request.
 	///
-	void post(QString route, QString content);
+	/// @return the pending reply, deleted later once it has finished
+	///
+	QNetworkReply* post(QString route, QString content);
+
+	///
+	/// Send a PUT request which outlives the bridge, through a network manager of its own
+	/// which deletes itself once the request has finished or has been aborted on timeout.
+	///
+	/// @param route the route of the request.
+	///
+	/// @param content the content of the request.
+	///
+	/// @param timeout_ms the time after which the request is aborted.
+	///
+	/// @return the pending reply, deleted together with its manager
+	///
+	QNetworkReply* postDetached(QString route, QString content, int timeout_ms);
 };
 
 /**
@@ -192,12 +219,127 @@ public:
 	void setColor(CiColor color, float brightnessFactor = 1.0f);
 	CiColor getColor() const;
 
+	///
+	/// @return the light id
+	///
+	unsigned int getId() const;
+
 	///
 	/// @return the color space of the light determined by the model id reported by the bridge.
 	CiColorTriangle getColorSpace() const;
 
 };
 
+/// Entertainment streaming port of the bridge
+#define HUE_STREAM_PORT 2100
+/// Time in ms after which the deactivation of the stream on destruction is aborted
+#define HUE_STREAM_DEACTIVATE_TIMEOUT 1000
+/// Minimum time between two stream messages, the bridge forwards at 25Hz and recommends 50Hz to cover udp losses
+#define HUE_STREAM_INTERVAL 20
+
+/**
+ * Streams the colors of all lights of an entertainment group in one binary "HueStream" (v1) message per frame,
+ * instead of one REST call per light. Frames which arrive faster than the stream interval are merged,
+ * the newest one is sent as soon as the interval elapsed.
+ */
+class PhilipsHueStream : public QObject
+{
+	Q_OBJECT
+
+public:
+	///
+	/// @param log the logger
+	/// @param host the address of the bridge
+	/// @param port the streaming port
+	/// @param username the bridge username, used as PSK identity
+	/// @param clientkey the PSK as hex string, an empty key streams unencrypted (local test receivers only)
+	/// @param interval_ms the minimum time between two messages
+	///
+	PhilipsHueStream(Logger* log, const QString& host, quint16 port, const QString& username, const QString& clientkey, int interval_ms = HUE_STREAM_INTERVAL);
+	~PhilipsHueStream();
+
+	///
+	/// Open the stream, performs the DTLS handshake for encrypted streams
+	///
+	void open();
+
+	///
+	/// Close the stream, pending colors are sent right away regardless of the stream interval
+	///
+	void close();
+
+	///
+	/// @return true if messages can be sent
+	///
+	bool isOpen() const;
+
+	///
+	/// Set the colors of the next message
+	///
+	/// @param lightIds the light ids
+	/// @param colors one color per light id
+	/// @param brightnessFactor the factor to apply to the colors
+	///
+	void setColors(const std::vector<unsigned int>& lightIds, const std::vector<ColorRgb>& colors, float brightnessFactor = 1.0f);
+
+	///
+	/// Pack a HueStream v1 message with 16 bit RGB colors
+	///
+	/// @param message the message buffer, reused to avoid reallocation
+	/// @param sequence the sequence number
+	/// @param lightIds the light ids
+	/// @param colors one color per light id
+	/// @param brightnessFactor the factor to apply to the colors
+	///
+	static void buildMessage(QByteArray& message, uint8_t sequence, const std::vector<unsigned int>& lightIds, const std::vector<ColorRgb>& colors, float brightnessFactor);
+
+private slots:
+	///
+	/// Send the pending message
+	///
+	void sendMessage();
+
+#ifdef HUE_STREAM_DTLS
+	///
+	/// Continue the DTLS handshake with received datagrams
+	///
+	void readPendingDatagrams();
+
+	///
+	/// Provide username and clientkey to the DTLS handshake
+	///
+	void pskRequired(QSslPreSharedKeyAuthenticator* authenticator);
+
+	///
+	/// Retransmit handshake messages on timeout
+	///
+	void handshakeTimeout();
+#endif
+
+private:
+	Logger* _log;
+	QUdpSocket _socket;
+	QHostAddress _host;
+	quint16 _port;
+	QString _username;
+	QByteArray _clientkey;
+	/// Minimum time between two messages
+	int _interval_ms;
+	/// Message of the newest frame
+	QByteArray _message;
+	/// True if _message has not been sent yet
+	bool _pending;
+	/// Sequence number of the next message
+	uint8_t _sequence;
+	/// Time since the last sent message
+	QElapsedTimer _lastSent;
+	/// Sends the pending message once the interval elapsed
+	QTimer _paceTimer;
+#ifdef HUE_STREAM_DTLS
+	QDtls* _dtls;
+#endif
+};
+
 /**
  * Implementation for the Philips Hue system.
  *
@@ -262,4 +404,22 @@ private:
 	std::vector<unsigned int> lightIds;
 	/// Array to save the lamps.
 	std::vector<PhilipsHueLight> lights;
+
+	/// Stream colors through the entertainment API instead of REST calls
+	bool useEntertainmentApi;
+	/// The entertainment group which contains the lights
+	int groupId;
+	/// The entertainment stream, only used with useEntertainmentApi
+	PhilipsHueStream* stream;
+	/// Ids of the created lights in stream order
+	std::vector<unsigned int> streamLightIds;
+
+	///
+	/// @param active the new streaming state of the entertainment group
+	///
+	/// @param detached send the request through PhilipsHueBridge::postDetached, it outlives the device
+	///
+	/// @return the pending reply of the bridge
+	///
+	QNetworkReply* setStreamActive(bool active, bool detached = false);
 };
@@ -0,0 +1,60 @@
+#include <cstring>
+
+// hyperion local includes
+#include "LedDeviceUdpDdp.h"
+
+LedDeviceUdpDdp::LedDeviceUdpDdp(const QJsonObject &deviceConfig)
+	: ProviderUdp()
+{
+	_deviceReady = init(deviceConfig);
+}
+
+bool LedDeviceUdpDdp::init(const QJsonObject &deviceConfig)
+{
+	_port = DDP_DEFAULT_PORT;
+	ProviderUdp::init(deviceConfig);
+	_ddpId = deviceConfig["destinationId"].toInt(DDP_ID_DISPLAY);
+
+	return true;
+}
+
+LedDevice* LedDeviceUdpDdp::construct(const QJsonObject &deviceConfig)
+{
+	return new LedDeviceUdpDdp(deviceConfig);
+}
+
+int LedDeviceUdpDdp::write(const std::vector<ColorRgb> &ledValues)
+{
+	int retVal = 0;
+	const uint8_t * rawdata = reinterpret_cast<const uint8_t *>(ledValues.data());
+
+	// the sequence number wraps from 15 to 1
+	_ddpSequence = (_ddpSequence % 15) + 1;
+
+	for (int offset = 0; offset < _ledRGBCount; offset += DDP_MAX_DATA)
+	{
+		const int length = qMin(_ledRGBCount - offset, DDP_MAX_DATA);
+		const bool lastPacket = (offset + length == _ledRGBCount);
+
+		// the receiver shows the frame with the packet that has the push flag
+		_ddpPacket[0] = DDP_FLAGS_VER1 | (lastPacket ? DDP_FLAGS_PUSH : 0);
+		_ddpPacket[1] = _ddpSequence;
+		_ddpPacket[2] = DDP_TYPE_RGB24;
+		_ddpPacket[3] = _ddpId;
+		_ddpPacket[4] = (offset >> 24) & 0xFF;
+		_ddpPacket[5] = (offset >> 16) & 0xFF;
+		_ddpPacket[6] = (offset >>  8) & 0xFF;
+		_ddpPacket[7] = (offset      ) & 0xFF;
+		_ddpPacket[8] = (length >>  8) & 0xFF;
+		_ddpPacket[9] = (length      ) & 0xFF;
+
+		memcpy(_ddpPacket + DDP_HEADER_SIZE, rawdata + offset, length);
+
+		if (writeBytes(DDP_HEADER_SIZE + length, _ddpPacket) < 0)
+		{
+			retVal = -1;
+		}
+	}
+
+	return retVal;
+}
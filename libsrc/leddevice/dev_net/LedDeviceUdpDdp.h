@@ -0,0 +1,64 @@
+#pragma once
+
+// hyperion includes
+#include "ProviderUdp.h"
+
+/**
+ *
+ * DDP (Distributed Display Protocol), see http://www.3waylabs.com/ddp/
+ *
+ **/
+
+#define DDP_DEFAULT_PORT 4048
+
+/* DDP header */
+#define DDP_HEADER_SIZE 10
+#define DDP_FLAGS_VER1 0x40
+#define DDP_FLAGS_PUSH 0x01
+#define DDP_TYPE_RGB24 0x0B
+#define DDP_ID_DISPLAY 1
+
+/* 480 rgb leds per packet, the payload fits into a standard ethernet frame */
+#define DDP_MAX_DATA 1440
+
+///
+/// Implementation of the LedDevice interface for sending led colors via udp/DDP packets
+///
+class LedDeviceUdpDdp : public ProviderUdp
+{
+public:
+	///
+	/// Constructs specific LedDevice
+	///
+	/// @param deviceConfig json device config
+	///
+	LedDeviceUdpDdp(const QJsonObject &deviceConfig);
+
+	///
+	/// Sets configuration
+	///
+	/// @param deviceConfig the json device config
+	/// @return true if success
+	bool init(const QJsonObject &deviceConfig);
+
+	/// constructs leddevice
+	static LedDevice* construct(const QJsonObject &deviceConfig);
+
+private:
+	///
+	/// Writes the led color values to the led-device
+	///
+	/// @param ledValues The color-value per led
+	/// @return Zero on succes else negative
+	///
+	virtual int write(const std::vector<ColorRgb> &ledValues);
+
+	/// Packet buffer, header and payload
+	uint8_t _ddpPacket[DDP_HEADER_SIZE + DDP_MAX_DATA];
+
+	/// Sequence number 1-15, 0 is reserved for senders without sequence numbers
+	uint8_t _ddpSequence = 1;
+
+	/// Destination id of the receiver
+	uint8_t _ddpId = DDP_ID_DISPLAY;
+};
@@ -12,12 +12,34 @@
 #include <QResource>
 #include <QDateTime>
 #include <QHostInfo>
+#include <QtEndian>
 
 // hyperion util includes
 #include "utils/ColorRgb.h"
 
 // project includes
 #include "ProtoClientConnection.h"
+#include "ProtoSharedMemory.h"
+
+/// Interval of the success replies with ReplyMode ErrorsOnly in ms
+const qint64 HEARTBEAT_INTERVAL = 1000;
+
+/// Largest accepted image in bytes, 3 bytes per pixel
+const qint64 MAX_IMAGE_SIZE = 64 * 1024 * 1024;
+
+namespace {
+	///
+	/// @return The size in bytes of an image with the given dimensions, -1 if they are invalid or too large
+	///
+	qint64 imageSize(int width, int height)
+	{
+		if (width <= 0 || height <= 0 || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE)
+			return -1;
+
+		const qint64 size = qint64(width) * height * 3;
+		return (size <= MAX_IMAGE_SIZE) ? size : -1;
+	}
+}
 
 ProtoClientConnection::ProtoClientConnection(QTcpSocket *socket)
 	: QObject()
@@ -25,6 +47,12 @@ ProtoClientConnection::ProtoClientConnection(QTcpSocket *socket)
 	, _hyperion(Hyperion::getInstance())
 	, _priority(-1)
 	, _clientAddress(QHostInfo::fromName(socket->peerAddress().toString()).hostName())
+	, _lastImageData()
+	, _sharedMemory(nullptr)
+	, _sharedMemorySlotSize(0)
+	, _sharedImage()
+	, _replyMode(hyperionnet::ReplyMode_All)
+	, _lastReplyTime(0)
 {
 	// connect internal signals and slots
 	connect(_socket, SIGNAL(disconnected()), this, SLOT(socketClosed()));
@@ -33,6 +61,7 @@ ProtoClientConnection::ProtoClientConnection(QTcpSocket *socket)
 
 ProtoClientConnection::~ProtoClientConnection()
 {
+	delete _sharedMemory;
 	delete _socket;
 }
 
@@ -74,7 +103,13 @@ void ProtoClientConnection::readData()
 		auto message = hyperionnet::GetRequest(msgData);
 
 		handleMessage(message);
-		emit newMessage(msgData,messageSize);
+
+		// shared memory requests are meaningless for other hosts, shared images are relayed with newImage
+		const hyperionnet::Command command = message->command_type();
+		if (command != hyperionnet::Command_SharedMemory && command != hyperionnet::Command_SharedImage)
+		{
+			emit newMessage(msgData,messageSize);
+		}
 	}
 }
 
@@ -102,6 +137,12 @@ void ProtoClientConnection::handleMessage(const hyperionnet::Request * req)
 		handleClearCommand(static_cast<const hyperionnet::Clear*>(reqPtr));
 	} else if ((reqPtr = req->command_as_Register()) != nullptr) {
 		handleRegisterCommand(static_cast<const hyperionnet::Register*>(reqPtr));
+	} else if ((reqPtr = req->command_as_LedColors()) != nullptr) {
+		handleLedColorsCommand(static_cast<const hyperionnet::LedColors*>(reqPtr));
+	} else if ((reqPtr = req->command_as_SharedImage()) != nullptr) {
+		handleSharedImageCommand(static_cast<const hyperionnet::SharedImage*>(reqPtr));
+	} else if ((reqPtr = req->command_as_SharedMemory()) != nullptr) {
+		handleSharedMemoryCommand(static_cast<const hyperionnet::SharedMemory*>(reqPtr));
 	} else {
 		sendErrorReply("Received invalid packet.");
 		handleNotImplemented();
@@ -125,7 +166,19 @@ void ProtoClientConnection::handleColorCommand(const hyperionnet::Color *colorRe
 }
 
 void ProtoClientConnection::handleRegisterCommand(const hyperionnet::Register *regReq) {
-	_priority = regReq->priority();
+	// same range as the json api, the lowest priorities belong to the background effect and the black
+	const int priority = regReq->priority();
+	if (priority < 1 || priority > 253)
+	{
+		// marked as answer to the register, which the client doesn't count as pending request
+		auto reply = hyperionnet::CreateReplyDirect(builder, "Priority out of range, valid are 1-253", -1, -1, 0);
+		builder.Finish(reply);
+		sendMessage();
+		return;
+	}
+
+	_priority = priority;
+	_replyMode = regReq->replies();
 	_hyperion->registerInput(_priority, hyperion::COMP_PROTOSERVER, regReq->origin()->c_str()+_clientAddress);
 }
 
@@ -141,8 +194,9 @@ void ProtoClientConnection::handleImageCommand(const hyperionnet::Image *image)
 		const auto & imageData = img->data();
 		const int width = img->width();
 		const int height = img->height();
-		
-		if ((int) imageData->size() != width*height*3)
+		const qint64 size = imageSize(width, height);
+
+		if (imageData == nullptr || size < 0 || qint64(imageData->size()) != size)
 		{
 			sendErrorReply("Size of image data does not match with the width and height");
 			return;
@@ -150,13 +204,173 @@ void ProtoClientConnection::handleImageCommand(const hyperionnet::Image *image)
 
 		Image<ColorRgb> image(width, height);
 		memmove(image.memptr(), imageData->data(), imageData->size());
-		_hyperion->setInputImage(_priority, image, duration);
+		if (!_hyperion->setInputImage(_priority, image, duration))
+		{
+			sendErrorReply("Priority is not registered, send a Register command first");
+			return;
+		}
+	}
+	else if ((reqPtr = image->data_as_CompressedImage()) != nullptr)
+	{
+		const auto *img = static_cast<const hyperionnet::CompressedImage*>(reqPtr);
+		const int width = img->width();
+		const int height = img->height();
+		const qint64 size = imageSize(width, height);
+
+		// qUncompress allocates the length of the big endian prefix, it has to match before anything is allocated
+		const auto & compressed = img->data();
+		if (size < 0 || compressed->size() < 4 || qint64(qFromBigEndian<quint32>(compressed->data())) != size)
+		{
+			sendErrorReply("Size of image data does not match with the width and height");
+			return;
+		}
+
+		QByteArray imageData = qUncompress(compressed->data(), int(compressed->size()));
+		if (imageData.size() != size)
+		{
+			sendErrorReply("Size of image data does not match with the width and height");
+			return;
+		}
+
+		if (img->delta())
+		{
+			if (_lastImageData.size() != imageData.size())
+			{
+				sendErrorReply("Delta image without a previous image of the same size");
+				return;
+			}
+
+			// restore the pixels from the difference to the previous image
+			uint8_t* data = reinterpret_cast<uint8_t*>(imageData.data());
+			const uint8_t* previous = reinterpret_cast<const uint8_t*>(_lastImageData.constData());
+			for (int i = 0; i < imageData.size(); ++i)
+			{
+				data[i] ^= previous[i];
+			}
+		}
+		_lastImageData = imageData;
+
+		Image<ColorRgb> image(width, height);
+		memcpy(image.memptr(), imageData.constData(), imageData.size());
+		if (!_hyperion->setInputImage(_priority, image, duration))
+		{
+			sendErrorReply("Priority is not registered, send a Register command first");
+			return;
+		}
 	}
 
 	// send reply
 	sendSuccessReply();
 }
 
+void ProtoClientConnection::handleLedColorsCommand(const hyperionnet::LedColors *ledColors)
+{
+	// extract parameters
+	const auto & colorData = ledColors->data();
+	const int offset = ledColors->offset();
+	const unsigned ledCount = _hyperion->getLedCount();
+
+	if (colorData->size() % 3 != 0)
+	{
+		sendErrorReply("Size of led color data is not a multiple of 3");
+		return;
+	}
+
+	const unsigned count = colorData->size() / 3;
+	if (offset < 0 || unsigned(offset) + count > ledCount)
+	{
+		sendErrorReply("Led colors exceed the configured led count");
+		return;
+	}
+
+	// keep the untouched leds of a partial update, reset on led count changes
+	if (_ledColors.size() != ledCount)
+	{
+		_ledColors.assign(ledCount, ColorRgb::BLACK);
+	}
+	memcpy(_ledColors.data() + offset, colorData->data(), colorData->size());
+
+	if (!_hyperion->setInput(_priority, _ledColors, ledColors->duration()))
+	{
+		sendErrorReply("Priority is not registered, send a Register command first");
+		return;
+	}
+
+	// send reply
+	sendSuccessReply();
+}
+
+void ProtoClientConnection::handleSharedMemoryCommand(const hyperionnet::SharedMemory *sharedMemory)
+{
+	delete _sharedMemory;
+	_sharedMemory = nullptr;
+	_sharedMemorySlotSize = 0;
+
+	// the segment of a remote client is no segment of this host
+	const int slotSize = sharedMemory->slotSize();
+	bool attached = false;
+	if (_socket->peerAddress().isLoopback() && slotSize > 0 && slotSize <= ProtoSharedMemory::MAX_SLOT_SIZE)
+	{
+		_sharedMemory = new QSharedMemory(QString::fromUtf8(sharedMemory->key()->c_str()));
+		attached = _sharedMemory->attach(QSharedMemory::ReadWrite) && qint64(_sharedMemory->size()) >= ProtoSharedMemory::segmentSize(slotSize);
+		if (attached)
+		{
+			_sharedMemorySlotSize = slotSize;
+		}
+		else
+		{
+			delete _sharedMemory;
+			_sharedMemory = nullptr;
+		}
+	}
+
+	// the client waits for this reply with any reply mode
+	auto reply = hyperionnet::CreateReplyDirect(builder, attached ? nullptr : "Unable to attach to the shared memory", -1, attached ? 1 : 0);
+	builder.Finish(reply);
+	sendMessage();
+}
+
+void ProtoClientConnection::handleSharedImageCommand(const hyperionnet::SharedImage *sharedImage)
+{
+	const int slot = sharedImage->slot();
+	const int width = sharedImage->width();
+	const int height = sharedImage->height();
+
+	if (_sharedMemory == nullptr || slot < 0 || slot >= ProtoSharedMemory::SLOTS)
+	{
+		sendErrorReply("Shared image without an attached shared memory slot");
+		return;
+	}
+
+	const qint64 size = imageSize(width, height);
+	if (size < 0 || size > _sharedMemorySlotSize)
+	{
+		sendErrorReply("Size of image data does not match with the width and height");
+		return;
+	}
+
+	QAtomicInt* state = ProtoSharedMemory::slotState(_sharedMemory->data(), slot);
+	if (state->loadAcquire() != ProtoSharedMemory::SLOT_WRITTEN)
+	{
+		sendErrorReply("Shared image slot has not been written");
+		return;
+	}
+
+	// copy the pixels out of the slot, which is free for the client again
+	_sharedImage.resize(width, height);
+	memcpy(_sharedImage.memptr(), ProtoSharedMemory::slotData(_sharedMemory->data(), slot, _sharedMemorySlotSize), _sharedImage.size());
+	state->storeRelease(ProtoSharedMemory::SLOT_FREE);
+
+	if (!_hyperion->setInputImage(_priority, _sharedImage, sharedImage->duration()))
+	{
+		sendErrorReply("Priority is not registered, send a Register command first");
+		return;
+	}
+	emit newImage(_sharedImage, sharedImage->duration());
+
+	// send reply
+	sendSuccessReply();
+}
 
 void ProtoClientConnection::handleClearCommand(const hyperionnet::Clear *clear)
 {
@@ -192,10 +406,17 @@ void ProtoClientConnection::sendMessage()
 	_socket->write((const char *)buffer, size);
 	_socket->flush();
 	builder.Clear();
+	_lastReplyTime = QDateTime::currentMSecsSinceEpoch();
 }
 
 void ProtoClientConnection::sendSuccessReply()
 {
+	// the client only wants errors, a heartbeat shows that the connection is alive
+	if (_replyMode == hyperionnet::ReplyMode_ErrorsOnly && QDateTime::currentMSecsSinceEpoch() - _lastReplyTime < HEARTBEAT_INTERVAL)
+	{
+		return;
+	}
+
 	auto reply = hyperionnet::CreateReplyDirect(builder);
 	builder.Finish(reply);
 
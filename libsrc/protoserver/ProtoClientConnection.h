@@ -8,6 +8,7 @@
 #include <QTcpSocket>
 #include <QStringList>
 #include <QString>
+#include <QSharedMemory>
 
 // Hyperion includes
 #include <hyperion/Hyperion.h>
@@ -54,6 +55,13 @@ signals:
 	void connectionClosed(ProtoClientConnection * connection);
 	void newMessage(const uint8_t* msgData, uint32_t messageSize);
 
+	///
+	/// Signal which is emitted for an image received through shared memory, the request itself refers to this host
+	/// @param image The image
+	/// @param duration The duration in milliseconds
+	///
+	void newImage(const Image<ColorRgb> & image, int duration);
+
 private slots:
 	///
 	/// Slot called when new data has arrived
@@ -87,6 +95,13 @@ private:
 	///
 	void handleImageCommand(const hyperionnet::Image * image);
 
+	///
+	/// Handle an incoming LedColors message
+	///
+	/// @param ledColors incoming data
+	///
+	void handleLedColorsCommand(const hyperionnet::LedColors * ledColors);
+
 	///
 	/// Handle an incoming Clear message
 	///
@@ -101,6 +116,20 @@ private:
 	///
 	void handleRegisterCommand(const hyperionnet::Register *reg);
 
+	///
+	/// Handle an incoming SharedMemory message, attaches to the segment of a client on the same host
+	///
+	/// @param sharedMemory incoming data
+	///
+	void handleSharedMemoryCommand(const hyperionnet::SharedMemory * sharedMemory);
+
+	///
+	/// Handle an incoming SharedImage message
+	///
+	/// @param sharedImage incoming data
+	///
+	void handleSharedImageCommand(const hyperionnet::SharedImage * sharedImage);
+
 	///
 	/// Handle an incoming message of unknown type
 	///
@@ -112,7 +141,7 @@ private:
 	void sendMessage();
 
 	///
-	/// Send a standard reply indicating success
+	/// Send a standard reply indicating success, with ReplyMode ErrorsOnly only as heartbeat
 	///
 	void sendSuccessReply();
 
@@ -135,6 +164,27 @@ private:
 	/// address of client
 	QString _clientAddress;
 
+	/// Last led colors received with LedColors, base for partial updates
+	std::vector<ColorRgb> _ledColors;
+
+	/// Pixels of the last compressed image, base of delta images
+	QByteArray _lastImageData;
+
+	/// The shared memory segment of the client, nullptr if none has been announced
+	QSharedMemory * _sharedMemory;
+
+	/// Size of the slots of the shared memory segment
+	int _sharedMemorySlotSize;
+
+	/// Image which receives the shared memory images, reallocated only if an image is larger
+	Image<ColorRgb> _sharedImage;
+
+	/// The reply mode negotiated with Register
+	hyperionnet::ReplyMode _replyMode;
+
+	/// Time of the last reply in ms
+	qint64 _lastReplyTime;
+
 	// Flatbuffers builder
 	flatbuffers::FlatBufferBuilder builder;
 };
@@ -3,15 +3,40 @@
 
 // Qt includes
 #include <QRgb>
+#include <QCoreApplication>
 
 // protoserver includes
 #include "protoserver/ProtoConnection.h"
+#include "ProtoSharedMemory.h"
+
+// utils includes
+#include <utils/MetricsRegistry.h>
+
+/// Number of requests which may await their reply before frames are held back
+const int MAX_PENDING_REPLIES = 3;
 
 ProtoConnection::ProtoConnection(const QString & address) :
 	_socket(),
 	_skipReply(false),
 	_prevSocketState(QAbstractSocket::UnconnectedState),
-	_log(Logger::getInstance("PROTOCONNECTION"))
+	_log(Logger::getInstance("PROTOCONNECTION")),
+	_builder(),
+	_receiveBuffer(),
+	_queuedFrame(),
+	_pendingReplies(0),
+	_origin(),
+	_priority(-1),
+	_imageEncoding(ENCODING_RAW),
+	_deltaBase(),
+	_queuedImage(),
+	_queuedImageDuration(-1),
+	_imageQueued(false),
+	_bytesWritten(0),
+	_useSharedMemory(false),
+	_sharedMemory(nullptr),
+	_sharedMemorySlotSize(0),
+	_sharedMemoryAttached(false),
+	_sharedMemorySlot(0)
 	{
 	QStringList parts = address.split(":");
 	if (parts.size() != 2)
@@ -37,6 +62,8 @@ ProtoConnection::ProtoConnection(const QString & address) :
 
 	connect(&_timer,SIGNAL(timeout()), this, SLOT(connectToHost()));
 	connect(&_socket, SIGNAL(readyRead()), this, SLOT(readData()));
+	connect(&_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(sendQueuedFrame()));
+	connect(&_socket, SIGNAL(connected()), this, SLOT(sendRegister()));
 	_timer.start();
 }
 
@@ -44,45 +71,71 @@ ProtoConnection::~ProtoConnection()
 {
 	_timer.stop();
 	_socket.close();
+	delete _sharedMemory;
 }
 
 void ProtoConnection::readData()
 {
-	qint64 bytesAvail;
-	while((bytesAvail = _socket.bytesAvailable()))
-	{
-		// ignore until we get 4 bytes.
-		if (bytesAvail < 4) {
-			continue;
-		}
+	_receiveBuffer.append(_socket.readAll());
 
-		char sizeBuf[4];
-		 _socket.read(sizeBuf, sizeof(sizeBuf));
-
-		uint32_t messageSize =
-			((sizeBuf[0]<<24) & 0xFF000000) |
-			((sizeBuf[1]<<16) & 0x00FF0000) |
-			((sizeBuf[2]<< 8) & 0x0000FF00) |
-			((sizeBuf[3]    ) & 0x000000FF);
-
-		QByteArray buffer;
-		while((uint32_t)buffer.size() < messageSize)
+	// handle all complete replies, a partial one stays in the buffer until the rest arrives
+	while (_receiveBuffer.size() >= 4)
+	{
+		const uint8_t* sizeBuf = reinterpret_cast<const uint8_t*>(_receiveBuffer.constData());
+		const uint32_t messageSize =
+			(uint32_t(sizeBuf[0]) << 24) |
+			(uint32_t(sizeBuf[1]) << 16) |
+			(uint32_t(sizeBuf[2]) <<  8) |
+			(uint32_t(sizeBuf[3])      );
+
+		if (uint32_t(_receiveBuffer.size()) - 4 < messageSize)
 		{
-			_socket.waitForReadyRead();
-			buffer.append(_socket.read(messageSize - buffer.size()));
+			break;
 		}
 
-		const uint8_t* replyData = reinterpret_cast<const uint8_t*>(buffer.constData());
+		const uint8_t* replyData = sizeBuf + 4;
 		flatbuffers::Verifier verifier(replyData, messageSize);
 
-		if (!hyperionnet::VerifyReplyBuffer(verifier))
+		if (hyperionnet::VerifyReplyBuffer(verifier))
+		{
+			const hyperionnet::Reply* reply = hyperionnet::GetReply(replyData);
+
+			// the answer to the shared memory announcement is awaited with any reply mode
+			if (reply->sharedMemory() != -1 && _sharedMemory != nullptr)
+			{
+				_sharedMemoryAttached = reply->sharedMemory() == 1;
+				if (_sharedMemoryAttached)
+				{
+					Info(_log, "Sending images through shared memory");
+				}
+				else
+				{
+					Warning(_log, "Hyperion refused the shared memory, sending images through the socket");
+					setSharedMemory(false);
+				}
+			}
+
+			if (!_skipReply)
+			{
+				// video mode changes are sent by the server on its own, a register is only answered if rejected,
+				// all other replies answer a counted request
+				if (reply->video() == -1 && reply->registered() == -1 && _pendingReplies > 0)
+				{
+					--_pendingReplies;
+				}
+				parseReply(reply);
+			}
+		}
+		else if (!_skipReply)
 		{
 			Error(_log, "Error while reading data from host");
-			return;
 		}
 
-		parseReply(hyperionnet::GetReply(replyData));
+		_receiveBuffer.remove(0, int(messageSize) + 4);
 	}
+
+	// a reply opens the window for the next frame
+	sendQueuedFrame();
 }
 
 void ProtoConnection::setSkipReply(bool skip)
@@ -90,33 +143,106 @@ void ProtoConnection::setSkipReply(bool skip)
 	_skipReply = skip;
 }
 
+void ProtoConnection::setRegister(const QString & origin, int priority)
+{
+	_origin = origin;
+	_priority = priority;
+
+	if (_socket.state() == QAbstractSocket::ConnectedState)
+	{
+		sendRegister();
+	}
+}
+
+void ProtoConnection::sendRegister()
+{
+	if (_priority < 0)
+	{
+		return;
+	}
+
+	const hyperionnet::ReplyMode replies = _skipReply ? hyperionnet::ReplyMode_ErrorsOnly : hyperionnet::ReplyMode_All;
+	auto registerReq = hyperionnet::CreateRegisterDirect(_builder, QSTRING_CSTR(_origin), _priority, replies);
+	auto req = hyperionnet::CreateRequest(_builder, hyperionnet::Command_Register, registerReq.Union());
+
+	sendRequest(req);
+}
+
+void ProtoConnection::setSharedMemory(bool enable)
+{
+	_useSharedMemory = enable;
+	if (!enable)
+	{
+		delete _sharedMemory;
+		_sharedMemory = nullptr;
+		_sharedMemoryAttached = false;
+	}
+}
+
+void ProtoConnection::setImageEncoding(ImageEncoding encoding)
+{
+	_imageEncoding = encoding;
+}
+
+QString ProtoConnection::getAddress() const
+{
+	return QString("%1:%2").arg(_host).arg(_port);
+}
+
 void ProtoConnection::setColor(const ColorRgb & color, int duration)
 {
-	auto colorReq = hyperionnet::CreateColor(builder, (color.red << 16) | (color.green << 8) | color.blue, duration);
-	auto req = hyperionnet::CreateRequest(builder,hyperionnet::Command_Color, colorReq.Union());
+	auto colorReq = hyperionnet::CreateColor(_builder, (color.red << 16) | (color.green << 8) | color.blue, duration);
+	auto req = hyperionnet::CreateRequest(_builder,hyperionnet::Command_Color, colorReq.Union());
 
-	builder.Finish(req);
-	sendMessage(builder.GetBufferPointer(), builder.GetSize());
+	sendRequest(req);
 }
 
 void ProtoConnection::setImage(const Image<ColorRgb> &image, int duration)
 {
-	auto imgData = builder.CreateVector(reinterpret_cast<const uint8_t*>(image.memptr()), image.size());
-	auto rawImg = hyperionnet::CreateRawImage(builder, imgData, image.width(), image.height());
-	auto imageReq = hyperionnet::CreateImage(builder, hyperionnet::ImageType_RawImage, rawImg.Union(), duration);
-	auto req = hyperionnet::CreateRequest(builder,hyperionnet::Command_Image,imageReq.Union());
+	if (_imageEncoding != ENCODING_RAW || _useSharedMemory)
+	{
+		if (_socket.state() != QAbstractSocket::ConnectedState)
+		{
+			return;
+		}
+
+		// the image is encoded when it is sent, so a delta refers to the image the server has received.
+		// A shared memory slot is only taken by an image which is sent right away
+		if (!isReadyForFrame())
+		{
+			if (_imageQueued || !_queuedFrame.isEmpty())
+				MetricsRegistry::add(MetricsRegistry::DROPPED_FORWARDER);
+
+			_queuedImage = image;
+			_queuedImageDuration = duration;
+			_imageQueued = true;
+			_queuedFrame.clear();
+			return;
+		}
+
+		_imageQueued = false;
+		sendImage(image, duration);
+		return;
+	}
+
+	sendRawImage(image, duration);
+}
+
+void ProtoConnection::setLedColors(const std::vector<ColorRgb> & ledColors, int offset, int duration)
+{
+	auto colorData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(ledColors.data()), ledColors.size() * sizeof(ColorRgb));
+	auto ledColorsReq = hyperionnet::CreateLedColors(_builder, colorData, offset, duration);
+	auto req = hyperionnet::CreateRequest(_builder,hyperionnet::Command_LedColors, ledColorsReq.Union());
 
-	builder.Finish(req);
-	sendMessage(builder.GetBufferPointer(), builder.GetSize());
+	sendRequest(req);
 }
 
 void ProtoConnection::clear(int priority)
 {
-	auto clearReq = hyperionnet::CreateClear(builder, priority);
-	auto req = hyperionnet::CreateRequest(builder,hyperionnet::Command_Clear, clearReq.Union());
+	auto clearReq = hyperionnet::CreateClear(_builder, priority);
+	auto req = hyperionnet::CreateRequest(_builder,hyperionnet::Command_Clear, clearReq.Union());
 
-	builder.Finish(req);
-	sendMessage(builder.GetBufferPointer(), builder.GetSize());
+	sendRequest(req);
 }
 
 void ProtoConnection::clearAll()
@@ -129,6 +255,18 @@ void ProtoConnection::connectToHost()
 	// try connection only when
 	if (_socket.state() == QAbstractSocket::UnconnectedState)
 	{
+	   // a new connection starts without the data of the previous one
+	   _receiveBuffer.clear();
+	   _queuedFrame.clear();
+	   _imageQueued = false;
+	   _deltaBase.clear();
+	   _pendingReplies = 0;
+
+	   // the segment is announced to the new connection with the next image
+	   delete _sharedMemory;
+	   _sharedMemory = nullptr;
+	   _sharedMemoryAttached = false;
+
 	   _socket.connectToHost(_host, _port);
 	   //_socket.waitForConnected(1000);
 	}
@@ -162,21 +300,224 @@ void ProtoConnection::sendMessage(const uint8_t* buffer, uint32_t size)
 		return;
 	}
 
-	const uint8_t header[] = {
-		uint8_t((size >> 24) & 0xFF),
-		uint8_t((size >> 16) & 0xFF),
-		uint8_t((size >>  8) & 0xFF),
-		uint8_t((size	  ) & 0xFF)};
+	// images and led colors are superseded by the next frame, other commands are always sent
+	const hyperionnet::Command command = hyperionnet::GetRequest(buffer)->command_type();
+	if (command == hyperionnet::Command_Image || command == hyperionnet::Command_LedColors)
+	{
+		if (_imageQueued || !_queuedFrame.isEmpty())
+			MetricsRegistry::add(MetricsRegistry::DROPPED_FORWARDER);
 
-	// write message
-	int count = 0;
-	count += _socket.write(reinterpret_cast<const char *>(header), 4);
-	count += _socket.write(reinterpret_cast<const char *>(buffer), size);
-	if (!_socket.waitForBytesWritten())
+		_imageQueued = false;
+		if (!isReadyForFrame())
+		{
+			_queuedFrame = QByteArray(reinterpret_cast<const char *>(buffer), int(size));
+			return;
+		}
+		_queuedFrame.clear();
+	}
+
+	// the server only answers a rejected register, with a reply which is marked as such
+	writeMessage(reinterpret_cast<const char *>(buffer), size, command != hyperionnet::Command_Register);
+}
+
+void ProtoConnection::sendQueuedFrame()
+{
+	if ((_queuedFrame.isEmpty() && !_imageQueued) || _socket.state() != QAbstractSocket::ConnectedState || !isReadyForFrame())
+	{
+		return;
+	}
+
+	if (_imageQueued)
+	{
+		_imageQueued = false;
+		sendImage(_queuedImage, _queuedImageDuration);
+		return;
+	}
+
+	QByteArray frame;
+	frame.swap(_queuedFrame);
+	writeMessage(frame.constData(), uint32_t(frame.size()), true);
+}
+
+void ProtoConnection::sendRequest(const flatbuffers::Offset<hyperionnet::Request> & request)
+{
+	_builder.Finish(request);
+	sendMessage(_builder.GetBufferPointer(), _builder.GetSize());
+
+	// keeps the allocated buffer for the next request
+	_builder.Clear();
+}
+
+void ProtoConnection::sendImage(const Image<ColorRgb> & image, int duration)
+{
+	if (_useSharedMemory && sendSharedImage(image, duration))
+	{
+		return;
+	}
+
+	if (_imageEncoding != ENCODING_RAW)
+	{
+		sendEncodedImage(image, duration);
+	}
+	else
+	{
+		sendRawImage(image, duration);
+	}
+}
+
+bool ProtoConnection::sendSharedImage(const Image<ColorRgb> & image, int duration)
+{
+	const int imageSize = int(image.size());
+	if (_sharedMemory == nullptr || imageSize > _sharedMemorySlotSize)
+	{
+		createSharedMemory(imageSize);
+		return false;
+	}
+
+	if (!_sharedMemoryAttached)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < ProtoSharedMemory::SLOTS; ++i)
+	{
+		const int slot = (_sharedMemorySlot + i) % ProtoSharedMemory::SLOTS;
+		QAtomicInt* state = ProtoSharedMemory::slotState(_sharedMemory->data(), slot);
+		if (state->loadAcquire() != ProtoSharedMemory::SLOT_FREE)
+		{
+			continue;
+		}
+
+		memcpy(ProtoSharedMemory::slotData(_sharedMemory->data(), slot, _sharedMemorySlotSize), image.memptr(), imageSize);
+		state->storeRelease(ProtoSharedMemory::SLOT_WRITTEN);
+		_sharedMemorySlot = (slot + 1) % ProtoSharedMemory::SLOTS;
+
+		auto sharedImageReq = hyperionnet::CreateSharedImage(_builder, slot, image.width(), image.height(), duration);
+		auto req = hyperionnet::CreateRequest(_builder, hyperionnet::Command_SharedImage, sharedImageReq.Union());
+
+		sendRequest(req);
+		return true;
+	}
+
+	// the server hasn't copied the images of all slots yet
+	return false;
+}
+
+void ProtoConnection::createSharedMemory(int imageSize)
+{
+	static int segmentCount = 0;
+
+	delete _sharedMemory;
+	_sharedMemory = nullptr;
+	_sharedMemoryAttached = false;
+
+	// the segment is a local resource, remote servers get the images through the socket
+	if (!_socket.peerAddress().isLoopback())
+	{
+		setSharedMemory(false);
+		return;
+	}
+
+	// page aligned slots, so slightly larger images fit as well
+	if (imageSize <= 0 || imageSize > ProtoSharedMemory::MAX_SLOT_SIZE - 4095)
+	{
+		setSharedMemory(false);
+		return;
+	}
+	_sharedMemorySlotSize = (imageSize + 4095) & ~4095;
+
+	const QString key = QString("hyperion-proto-%1-%2").arg(QCoreApplication::applicationPid()).arg(++segmentCount);
+	_sharedMemory = new QSharedMemory(key);
+	if (!_sharedMemory->create(int(ProtoSharedMemory::segmentSize(_sharedMemorySlotSize))))
+	{
+		Warning(_log, "Unable to create the shared memory, sending images through the socket: %s", QSTRING_CSTR(_sharedMemory->errorString()));
+		setSharedMemory(false);
+		return;
+	}
+
+	for (int slot = 0; slot < ProtoSharedMemory::SLOTS; ++slot)
+	{
+		ProtoSharedMemory::slotState(_sharedMemory->data(), slot)->storeRelease(ProtoSharedMemory::SLOT_FREE);
+	}
+	_sharedMemorySlot = 0;
+
+	auto sharedMemoryReq = hyperionnet::CreateSharedMemoryDirect(_builder, QSTRING_CSTR(key), _sharedMemorySlotSize);
+	auto req = hyperionnet::CreateRequest(_builder, hyperionnet::Command_SharedMemory, sharedMemoryReq.Union());
+
+	sendRequest(req);
+}
+
+void ProtoConnection::sendRawImage(const Image<ColorRgb> & image, int duration)
+{
+	auto imgData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(image.memptr()), image.size());
+	auto rawImg = hyperionnet::CreateRawImage(_builder, imgData, image.width(), image.height());
+	auto imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_RawImage, rawImg.Union(), duration);
+	auto req = hyperionnet::CreateRequest(_builder,hyperionnet::Command_Image,imageReq.Union());
+
+	sendRequest(req);
+}
+
+void ProtoConnection::sendEncodedImage(const Image<ColorRgb> & image, int duration)
+{
+	QByteArray pixels(reinterpret_cast<const char *>(image.memptr()), int(image.size()));
+	const bool delta = _imageEncoding == ENCODING_DELTA && _deltaBase.size() == pixels.size();
+
+	QByteArray compressed;
+	if (delta)
+	{
+		// unchanged pixels become zeros, which compress well
+		QByteArray difference(pixels);
+		uint8_t* data = reinterpret_cast<uint8_t*>(difference.data());
+		const uint8_t* previous = reinterpret_cast<const uint8_t*>(_deltaBase.constData());
+		for (int i = 0; i < difference.size(); ++i)
+		{
+			data[i] ^= previous[i];
+		}
+		compressed = qCompress(difference, 1);
+	}
+	else
+	{
+		compressed = qCompress(pixels, 1);
+	}
+
+	if (_imageEncoding == ENCODING_DELTA)
+	{
+		_deltaBase.swap(pixels);
+	}
+
+	auto imgData = _builder.CreateVector(reinterpret_cast<const uint8_t*>(compressed.constData()), compressed.size());
+	auto compressedImg = hyperionnet::CreateCompressedImage(_builder, imgData, image.width(), image.height(), delta);
+	auto imageReq = hyperionnet::CreateImage(_builder, hyperionnet::ImageType_CompressedImage, compressedImg.Union(), duration);
+	auto req = hyperionnet::CreateRequest(_builder,hyperionnet::Command_Image,imageReq.Union());
+
+	sendRequest(req);
+}
+
+bool ProtoConnection::isReadyForFrame() const
+{
+	return _socket.bytesToWrite() == 0 && (_skipReply || _pendingReplies < MAX_PENDING_REPLIES);
+}
+
+void ProtoConnection::writeMessage(const char* buffer, uint32_t size, bool expectReply)
+{
+	const char header[] = {
+		char((size >> 24) & 0xFF),
+		char((size >> 16) & 0xFF),
+		char((size >>  8) & 0xFF),
+		char((size	  ) & 0xFF)};
+
+	// the socket buffers the message and writes it from the event loop
+	if (_socket.write(header, 4) != 4 || _socket.write(buffer, size) != qint64(size))
 	{
 		Error(_log, "Error while writing data to host");
 		return;
 	}
+	_bytesWritten += 4 + size;
+
+	if (expectReply && !_skipReply)
+	{
+		++_pendingReplies;
+	}
 }
 
 bool ProtoConnection::parseReply(const hyperionnet::Reply *reply)
@@ -1,3 +1,6 @@
+// Qt includes
+#include <QCoreApplication>
+
 // protoserver includes
 #include "protoserver/ProtoConnectionWrapper.h"
 
@@ -10,7 +13,9 @@ ProtoConnectionWrapper::ProtoConnectionWrapper(const QString &address,
 	, _connection(address)
 {
 	_connection.setSkipReply(skipProtoReply);
-	// We should probably register with the ProtoConnection here <todo> <flatbuffers>
+	// the grabbers mostly run on the host of hyperiond
+	_connection.setSharedMemory(true);
+	_connection.setRegister(QCoreApplication::applicationName() + "@", _priority);
 	connect(&_connection, SIGNAL(setVideoMode(VideoMode)), this, SIGNAL(setVideoMode(VideoMode)));
 }
 
@@ -20,6 +25,5 @@ ProtoConnectionWrapper::~ProtoConnectionWrapper()
 
 void ProtoConnectionWrapper::receiveImage(const Image<ColorRgb> & image)
 {
-	// Skip the priority sending for now <todo> <flatbuffers>
 	_connection.setImage(image, _duration_ms);
 }
@@ -1,8 +1,11 @@
 // system includes
 #include <stdexcept>
+#include <cstring>
 
 // qt incl
 #include <QTcpServer>
+#include <QDateTime>
+#include <QElapsedTimer>
 
 // project includes
 #include <hyperion/Hyperion.h>
@@ -22,6 +25,13 @@ ProtoServer::ProtoServer(const QJsonDocument& config)
 	, _log(Logger::getInstance("PROTOSERVER"))
 	, _componentRegister( & _hyperion->getComponentRegister())
 	, _netOrigin(NetOrigin::getInstance())
+	, _forwarder_enabled(false)
+	, _forwardImageWidth(0)
+	, _forwardImageHeight(0)
+	, _forwardSkipUnchanged(false)
+	, _forwardImageProcessing(false)
+	, _lastForwardedImage()
+	, _lastForwardTime(0)
 {
 	Debug(_log,"Instance created");
 	connect( _server, SIGNAL(newConnection()), this, SLOT(newConnection()));
@@ -35,6 +45,7 @@ ProtoServer::ProtoServer(const QJsonDocument& config)
 		p->setSkipReply(true);
 		_proxy_connections << p;
 	}
+	handleSettingsUpdate(settings::NETFORWARD, _hyperion->getSetting(settings::NETFORWARD));
 
 	// listen for component changes
 	connect(_componentRegister, &ComponentRegister::updatedComponentState, this, &ProtoServer::componentStateChanged);
@@ -99,6 +110,24 @@ void ProtoServer::handleSettingsUpdate(const settings::type& type, const QJsonDo
 			start();
 		}
 	}
+	else if(type == settings::NETFORWARD)
+	{
+		const QJsonObject& obj = config.object();
+		_forwardImageWidth    = qMax(0, obj["imageWidth"].toInt(0));
+		_forwardImageHeight   = qMax(0, obj["imageHeight"].toInt(0));
+		_forwardSkipUnchanged = obj["skipUnchanged"].toBool(false);
+
+		const QString encoding = obj["encoding"].toString("raw");
+		const ProtoConnection::ImageEncoding imageEncoding = (encoding == "delta") ? ProtoConnection::ENCODING_DELTA
+			: (encoding == "compressed") ? ProtoConnection::ENCODING_COMPRESSED : ProtoConnection::ENCODING_RAW;
+		for (ProtoConnection* connection : _proxy_connections)
+		{
+			connection->setImageEncoding(imageEncoding);
+		}
+
+		_forwardImageProcessing = _forwardImageWidth > 0 || _forwardImageHeight > 0 || _forwardSkipUnchanged || imageEncoding != ProtoConnection::ENCODING_RAW;
+		_lastForwardedImage = Image<ColorRgb>();
+	}
 }
 
 uint16_t ProtoServer::getPort() const
@@ -121,6 +150,7 @@ void ProtoServer::newConnection()
 				// register slot for cleaning up after the connection closed
 				connect(connection, SIGNAL(connectionClosed(ProtoClientConnection*)), this, SLOT(closedConnection(ProtoClientConnection*)));
 				connect(connection, SIGNAL(newMessage(const uint8_t* , uint32_t)), this, SLOT(newMessage(const uint8_t* , uint32_t)));
+				connect(connection, SIGNAL(newImage(const Image<ColorRgb>&, int)), this, SLOT(newImage(const Image<ColorRgb>&, int)));
 
 				// register forward signal for video mode
 				connect(this, SIGNAL(videoMode(VideoMode)), connection, SLOT(setVideoMode(VideoMode)));
@@ -135,8 +165,101 @@ void ProtoServer::newConnection()
 
 void ProtoServer::newMessage(const uint8_t* buffer, uint32_t size)
 {
+	if (_forwardImageProcessing)
+	{
+		const hyperionnet::Image* image = hyperionnet::GetRequest(buffer)->command_as_Image();
+		const hyperionnet::RawImage* rawImage = (image != nullptr) ? image->data_as_RawImage() : nullptr;
+		if (rawImage != nullptr && rawImage->data() != nullptr && rawImage->width() > 0 && rawImage->height() > 0
+			&& int(rawImage->data()->size()) == rawImage->width() * rawImage->height() * 3)
+		{
+			forwardImage(reinterpret_cast<const ColorRgb*>(rawImage->data()->data()), rawImage->width(), rawImage->height(), image->duration());
+			return;
+		}
+	}
+
+	MessageForwarder* forwarder = _hyperion->getForwarder();
+	QElapsedTimer timer;
 	for (int i = 0; i < _proxy_connections.size(); ++i)
+	{
+		timer.start();
 		_proxy_connections.at(i)->sendMessage(buffer, size);
+		forwarder->addProtoStatistics(_proxy_connections.at(i)->getAddress(), _proxy_connections.at(i)->getBytesWritten(), timer.nsecsElapsed(), false);
+	}
+}
+
+void ProtoServer::newImage(const Image<ColorRgb> & image, int duration)
+{
+	if (_proxy_connections.isEmpty())
+	{
+		return;
+	}
+
+	if (_forwardImageProcessing)
+	{
+		forwardImage(image.memptr(), image.width(), image.height(), duration);
+		return;
+	}
+
+	MessageForwarder* forwarder = _hyperion->getForwarder();
+	QElapsedTimer timer;
+	for (ProtoConnection* connection : _proxy_connections)
+	{
+		timer.start();
+		connection->setImage(image, duration);
+		forwarder->addProtoStatistics(connection->getAddress(), connection->getBytesWritten(), timer.nsecsElapsed(), false);
+	}
+}
+
+void ProtoServer::forwardImage(const ColorRgb * pixels, int width, int height, int duration)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// downscale by pixel decimation to fit into the configured size
+	int factor = 1;
+	if (_forwardImageWidth > 0)
+		factor = qMax(factor, (width + _forwardImageWidth - 1) / _forwardImageWidth);
+	if (_forwardImageHeight > 0)
+		factor = qMax(factor, (height + _forwardImageHeight - 1) / _forwardImageHeight);
+
+	Image<ColorRgb> image(qMax(1, width / factor), qMax(1, height / factor));
+	for (unsigned y = 0; y < image.height(); ++y)
+	{
+		const ColorRgb* row = pixels + qMin(height - 1, int(y) * factor + factor / 2) * width;
+		for (unsigned x = 0; x < image.width(); ++x)
+		{
+			image(x, y) = row[qMin(width - 1, int(x) * factor + factor / 2)];
+		}
+	}
+
+	MessageForwarder* forwarder = _hyperion->getForwarder();
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	// unchanged images are repeated now and then, the targets would drop a priority with a duration otherwise
+	if (_forwardSkipUnchanged)
+	{
+		if (now - _lastForwardTime < 500
+			&& image.width() == _lastForwardedImage.width() && image.height() == _lastForwardedImage.height()
+			&& memcmp(image.memptr(), _lastForwardedImage.memptr(), image.size()) == 0)
+		{
+			for (ProtoConnection* connection : _proxy_connections)
+			{
+				forwarder->addProtoStatistics(connection->getAddress(), connection->getBytesWritten(), 0, true);
+			}
+			return;
+		}
+		_lastForwardedImage = image;
+	}
+	_lastForwardTime = now;
+
+	// the downscaling is shared by the targets
+	const qint64 sharedNs = timer.nsecsElapsed() / qMax(1, _proxy_connections.size());
+	for (ProtoConnection* connection : _proxy_connections)
+	{
+		timer.restart();
+		connection->setImage(image, duration);
+		forwarder->addProtoStatistics(connection->getAddress(), connection->getBytesWritten(), sharedNs + timer.nsecsElapsed(), false);
+	}
 }
 
 void ProtoServer::sendImageToProtoSlaves(int priority, const Image<ColorRgb> & image, int duration_ms)
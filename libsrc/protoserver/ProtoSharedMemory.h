@@ -0,0 +1,53 @@
+#pragma once
+
+// STL includes
+#include <climits>
+
+// Qt includes
+#include <QAtomicInt>
+
+///
+/// Layout of the shared memory segment, which a ProtoConnection on the same host as the ProtoServer announces
+/// with a SharedMemory request. The segment starts with the state of each slot followed by the slots,
+/// each holding the pixels of an image. The client writes an image into a free slot, marks it written and sends
+/// a SharedImage request with the slot index over the socket. The server copies the image and frees the slot.
+///
+namespace ProtoSharedMemory
+{
+	/// Number of slots, the client writes the next image while the server copies the previous one
+	const int SLOTS = 3;
+
+	/// Size of the slot states, keeps the pixels of the slots aligned
+	const int HEADER_SIZE = 64;
+
+	/// Slot states
+	const int SLOT_FREE = 0;
+	const int SLOT_WRITTEN = 1;
+
+	/// Largest slot size, the size of a segment has to fit into an int
+	const int MAX_SLOT_SIZE = (INT_MAX - HEADER_SIZE) / SLOTS;
+
+	///
+	/// @return The size of a segment with slots of the given size
+	///
+	inline qint64 segmentSize(int slotSize)
+	{
+		return HEADER_SIZE + SLOTS * qint64(slotSize);
+	}
+
+	///
+	/// @return The state of the slot, accessed with acquire/release ordering
+	///
+	inline QAtomicInt* slotState(void* segment, int slot)
+	{
+		return reinterpret_cast<QAtomicInt*>(segment) + slot;
+	}
+
+	///
+	/// @return The pixels of the slot
+	///
+	inline uchar* slotData(void* segment, int slot, int slotSize)
+	{
+		return reinterpret_cast<uchar*>(segment) + HEADER_SIZE + slot * slotSize;
+	}
+}
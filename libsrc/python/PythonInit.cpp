@@ -10,6 +10,7 @@
 
 // modules to init
 #include <effectengine/EffectModule.h>
+#include <effectengine/EffectInterpreterPool.h>
 #include <plugin/PluginModule.h>
 
 PythonInit::PythonInit()
@@ -29,5 +30,6 @@ PythonInit::~PythonInit()
 {
 	Debug(Logger::getInstance("DAEMON"), "Cleaning up Python interpreter");
 	PyEval_RestoreThread(mainThreadState);
+	EffectInterpreterPool::getInstance()->clear();
 	Py_Finalize();
 }
@@ -0,0 +1,66 @@
+// system includes
+#include <cstring>
+
+// project includes
+#include "DdpDecoder.h"
+
+/* DDP header, see http://www.3waylabs.com/ddp/ */
+#define DDP_HEADER_SIZE 10
+#define DDP_TIMECODE_SIZE 4
+#define DDP_FLAGS 0
+#define DDP_ID 3
+#define DDP_OFFSET 4
+#define DDP_LENGTH 8
+
+#define DDP_FLAGS_VER_MASK 0xc0
+#define DDP_FLAGS_VER1 0x40
+#define DDP_FLAGS_TIMECODE 0x10
+#define DDP_FLAGS_STORAGE 0x08
+#define DDP_FLAGS_REPLY 0x04
+#define DDP_FLAGS_QUERY 0x02
+#define DDP_FLAGS_PUSH 0x01
+
+/// ids from 246 on address status, config and control data
+#define DDP_ID_STATUS 246
+
+UdpDecoderDdp::UdpDecoderDdp()
+	: UdpDecoder()
+	, _assembly()
+	, _frameSize(0)
+{
+}
+
+bool UdpDecoderDdp::decode(const uint8_t* data, const qint64& size)
+{
+	if (size < DDP_HEADER_SIZE)
+		return false;
+
+	const uint8_t flags = data[DDP_FLAGS];
+	if ((flags & DDP_FLAGS_VER_MASK) != DDP_FLAGS_VER1
+		|| (flags & (DDP_FLAGS_STORAGE | DDP_FLAGS_REPLY | DDP_FLAGS_QUERY))
+		|| data[DDP_ID] >= DDP_ID_STATUS)
+	{
+		return false;
+	}
+
+	const int headerSize = DDP_HEADER_SIZE + ((flags & DDP_FLAGS_TIMECODE) ? DDP_TIMECODE_SIZE : 0);
+	const uint32_t offset = (uint32_t(data[DDP_OFFSET]) << 24) | (uint32_t(data[DDP_OFFSET+1]) << 16) | (uint32_t(data[DDP_OFFSET+2]) << 8) | uint32_t(data[DDP_OFFSET+3]);
+	const int length = qMin((data[DDP_LENGTH] << 8) | data[DDP_LENGTH+1], int(size) - headerSize);
+
+	if (length > 0 && offset <= uint32_t(UDP_MAX_FRAME_SIZE - length))
+	{
+		if (int(_assembly.size()) < int(offset) + length)
+			_assembly.resize(offset + length, 0);
+
+		memcpy(_assembly.data() + offset, data + headerSize, length);
+		_frameSize = qMax(_frameSize, int(offset) + length);
+	}
+
+	if ((flags & DDP_FLAGS_PUSH) && _frameSize > 0)
+	{
+		setFrame(_assembly.data(), _frameSize);
+		_frameSize = 0;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// project includes
+#include "UdpDecoder.h"
+
+///
+/// DDP (Distributed Display Protocol) data packets. Packets carry a byte offset into the frame,
+/// the frame is complete with the packet that has the push flag set
+///
+class UdpDecoderDdp : public UdpDecoder
+{
+public:
+	UdpDecoderDdp();
+
+	virtual bool decode(const uint8_t* data, const qint64& size);
+
+private:
+	/// Frame under assembly
+	std::vector<uint8_t> _assembly;
+
+	/// Size of the frame in bytes, as far as seen
+	int _frameSize;
+};
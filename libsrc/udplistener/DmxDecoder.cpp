@@ -0,0 +1,148 @@
+// system includes
+#include <cstring>
+
+// project includes
+#include "DmxDecoder.h"
+
+/* DMX */
+#define DMX_MAX 512
+
+/* E1.31 packet offsets and vectors */
+#define E131_ROOT_ID 4
+#define E131_ROOT_VECTOR 18
+#define E131_FRAME_VECTOR 40
+#define E131_FRAME_SEQ 111
+#define E131_FRAME_OPT 112
+#define E131_FRAME_UNIVERSE 113
+#define E131_DMP_VECTOR 117
+#define E131_DMP_COUNT 123
+#define E131_DMP_DATA 125
+#define E131_OPT_PREVIEW 0x80
+#define VECTOR_ROOT_E131_DATA 0x00000004
+#define VECTOR_E131_DATA_PACKET 0x00000002
+#define VECTOR_DMP_SET_PROPERTY 0x02
+
+/* Art-Net packet offsets */
+#define ARTNET_OPCODE 8
+#define ARTNET_SEQUENCE 12
+#define ARTNET_SUBUNI 14
+#define ARTNET_NET 15
+#define ARTNET_LENGTH 16
+#define ARTNET_DATA 18
+#define ARTNET_OP_DMX 0x5000
+
+/// late packets within this window of sequence numbers are dropped (as recommended by E1.31)
+#define SEQUENCE_WINDOW 20
+
+static const uint8_t E131_ACN_ID[12] = {0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00};
+
+static inline int readUint16(const uint8_t* data)
+{
+	return (data[0] << 8) | data[1];
+}
+
+static inline uint32_t readUint32(const uint8_t* data)
+{
+	return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+DmxDecoder::DmxDecoder(const QJsonObject& config)
+	: UdpDecoder()
+	, _firstUniverse(config["universe"].toInt(1))
+	, _universeSize(qBound(3, config["universeSize"].toInt(510), DMX_MAX))
+	, _assembly()
+	, _frameSize(0)
+	, _frameSequence(0)
+	, _frameComplete(false)
+	, _lastSequence(UDP_MAX_FRAME_SIZE / _universeSize, 0)
+	, _received(UDP_MAX_FRAME_SIZE / _universeSize)
+	, _expected(UDP_MAX_FRAME_SIZE / _universeSize)
+{
+}
+
+bool DmxDecoder::decodeUniverse(const int& universe, const uint8_t& sequence, const uint8_t* data, int channels)
+{
+	const int index = universe - _firstUniverse;
+	if (index < 0 || index >= _received.size() || channels <= 0)
+		return false;
+
+	// drop duplicated and late packets of this universe
+	const int8_t age = int8_t(sequence - _lastSequence[index]);
+	if (sequence != 0 && _lastSequence[index] != 0 && age <= 0 && age > -SEQUENCE_WINDOW)
+		return false;
+	_lastSequence[index] = sequence;
+
+	// a new sequence number or a repeated universe starts the next frame
+	if (_received.count(true) > 0 && (sequence != _frameSequence || _received.testBit(index)))
+	{
+		// the previous frame never completed, the sender changed its universes
+		if (!_frameComplete)
+			_expected = _received;
+
+		_received.fill(false);
+		_frameSize = 0;
+		_frameComplete = false;
+	}
+	_frameSequence = sequence;
+
+	// a complete frame got an additional universe, the sender added universes
+	if (_frameComplete)
+		_expected.setBit(index);
+
+	const int offset = index * _universeSize;
+	channels = qMin(channels, _universeSize);
+	if (int(_assembly.size()) < offset + channels)
+		_assembly.resize(offset + channels, 0);
+
+	memcpy(_assembly.data() + offset, data, channels);
+	_frameSize = qMax(_frameSize, offset + channels);
+	_received.setBit(index);
+
+	if (_received == _expected)
+	{
+		setFrame(_assembly.data(), _frameSize);
+		_frameComplete = true;
+		return true;
+	}
+	return false;
+}
+
+bool UdpDecoderE131::decode(const uint8_t* data, const qint64& size)
+{
+	// accept E1.31 data packets with the null start code only
+	if (size <= E131_DMP_DATA
+		|| memcmp(data + E131_ROOT_ID, E131_ACN_ID, sizeof(E131_ACN_ID)) != 0
+		|| readUint32(data + E131_ROOT_VECTOR) != VECTOR_ROOT_E131_DATA
+		|| readUint32(data + E131_FRAME_VECTOR) != VECTOR_E131_DATA_PACKET
+		|| data[E131_DMP_VECTOR] != VECTOR_DMP_SET_PROPERTY
+		|| data[E131_DMP_DATA] != 0)
+	{
+		return false;
+	}
+
+	// preview data is not meant for live output
+	if (data[E131_FRAME_OPT] & E131_OPT_PREVIEW)
+		return false;
+
+	// the property value count includes the start code
+	const int channels = qMin(readUint16(data + E131_DMP_COUNT) - 1, int(size) - E131_DMP_DATA - 1);
+
+	return decodeUniverse(readUint16(data + E131_FRAME_UNIVERSE), data[E131_FRAME_SEQ], data + E131_DMP_DATA + 1, channels);
+}
+
+bool UdpDecoderArtNet::decode(const uint8_t* data, const qint64& size)
+{
+	// accept ArtDmx packets only, the opcode is little endian
+	if (size <= ARTNET_DATA
+		|| memcmp(data, "Art-Net\0", 8) != 0
+		|| (data[ARTNET_OPCODE] | (data[ARTNET_OPCODE+1] << 8)) != ARTNET_OP_DMX)
+	{
+		return false;
+	}
+
+	const int universe = data[ARTNET_SUBUNI] | ((data[ARTNET_NET] & 0x7f) << 8);
+	const int channels = qMin(readUint16(data + ARTNET_LENGTH), int(size) - ARTNET_DATA);
+
+	// a sequence number of 0 disables resequencing
+	return decodeUniverse(universe, data[ARTNET_SEQUENCE], data + ARTNET_DATA, channels);
+}
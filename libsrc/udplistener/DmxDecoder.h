@@ -0,0 +1,83 @@
+#pragma once
+
+// Qt includes
+#include <QBitArray>
+
+// project includes
+#include "UdpDecoder.h"
+
+///
+/// Reassembles frames which are split across consecutive DMX universes. A frame is complete as soon as
+/// all universes of the previous frames have been received with the same sequence number. A new sequence
+/// number or a repeated universe starts the next frame; an incomplete frame at that point is dropped and
+/// the set of expected universes is learned again.
+///
+class DmxDecoder : public UdpDecoder
+{
+public:
+	///
+	/// @param config  The udpListener configuration (universe, universeSize)
+	///
+	DmxDecoder(const QJsonObject& config);
+
+protected:
+	///
+	/// @brief Add the channels of a single universe to the current frame
+	/// @param universe  The universe number
+	/// @param sequence  The sequence number, 0 if the sender does not use sequence numbers
+	/// @param data      The channel data (without start code)
+	/// @param channels  The number of channels
+	/// @return True if the frame has been completed with this universe
+	///
+	bool decodeUniverse(const int& universe, const uint8_t& sequence, const uint8_t* data, int channels);
+
+private:
+	/// First universe, mapped to the first led
+	int _firstUniverse;
+
+	/// Channels of a universe which carry led data
+	int _universeSize;
+
+	/// Frame under assembly
+	std::vector<uint8_t> _assembly;
+
+	/// Size of the frame in bytes, as far as seen
+	int _frameSize;
+
+	/// Sequence number of the frame under assembly
+	uint8_t _frameSequence;
+
+	/// True if the frame under assembly has already been published
+	bool _frameComplete;
+
+	/// Last sequence number per universe to drop late packets
+	std::vector<uint8_t> _lastSequence;
+
+	/// Universes received for the frame under assembly
+	QBitArray _received;
+
+	/// Universes which make up a complete frame
+	QBitArray _expected;
+};
+
+///
+/// E1.31 (sACN) data packets
+///
+class UdpDecoderE131 : public DmxDecoder
+{
+public:
+	UdpDecoderE131(const QJsonObject& config) : DmxDecoder(config) {};
+
+	virtual bool decode(const uint8_t* data, const qint64& size);
+};
+
+///
+/// Art-Net ArtDmx packets
+///
+class UdpDecoderArtNet : public DmxDecoder
+{
+public:
+	UdpDecoderArtNet(const QJsonObject& config) : DmxDecoder(config) {};
+
+	virtual bool decode(const uint8_t* data, const qint64& size);
+};
@@ -0,0 +1,140 @@
+// system includes
+#include <cstring>
+
+// hyperion includes
+#include <hyperion/MulticastPublisher.h>
+
+// project includes
+#include "MulticastDecoder.h"
+
+namespace {
+	inline quint32 readUInt16(const uint8_t* data)
+	{
+		return (quint32(data[0]) << 8) | quint32(data[1]);
+	}
+
+	inline quint32 readUInt32(const uint8_t* data)
+	{
+		return (quint32(data[0]) << 24) | (quint32(data[1]) << 16) | (quint32(data[2]) << 8) | quint32(data[3]);
+	}
+
+	/// @return True if the sequence number doesn't follow the reference, wraps around
+	inline bool isOutdated(quint32 sequence, quint32 reference)
+	{
+		return qint32(sequence - reference) <= 0;
+	}
+}
+
+UdpDecoderMulticast::UdpDecoderMulticast()
+	: UdpDecoder()
+	, _assembly()
+	, _received()
+	, _sequence(0)
+	, _fragmentCount(0)
+	, _frameSize(0)
+	, _receivedCount(0)
+	, _assembling(false)
+	, _session(0)
+	, _lastSequence(0)
+	, _hasLastSequence(false)
+	, _completedFrames(0)
+	, _lostFrames(0)
+{
+}
+
+void UdpDecoderMulticast::startFrame(quint32 sequence, int fragmentCount, int frameSize)
+{
+	_sequence      = sequence;
+	_fragmentCount = fragmentCount;
+	_frameSize     = frameSize;
+	_receivedCount = 0;
+	_assembling    = true;
+
+	// without reallocation as long as the frame size is stable
+	_assembly.resize(frameSize);
+	_received.assign(fragmentCount, false);
+}
+
+bool UdpDecoderMulticast::decode(const uint8_t* data, const qint64& size)
+{
+	if (size <= MULTICAST_HEADER_SIZE
+		|| data[0] != MULTICAST_MAGIC_0 || data[1] != MULTICAST_MAGIC_1 || data[2] != MULTICAST_VERSION)
+	{
+		return false;
+	}
+
+	const quint32 session       = readUInt32(data + 4);
+	const quint32 sequence      = readUInt32(data + 8);
+	const int     index         = int(readUInt16(data + 12));
+	const int     fragmentCount = int(readUInt16(data + 14));
+	const quint32 frameSize     = readUInt32(data + 16);
+	const int     length        = int(size) - MULTICAST_HEADER_SIZE;
+
+	// the layout has to match the fragmentation of the publisher
+	if (frameSize == 0 || frameSize > UDP_MAX_FRAME_SIZE
+		|| fragmentCount != int((frameSize + MULTICAST_FRAGMENT_SIZE - 1) / MULTICAST_FRAGMENT_SIZE)
+		|| index >= fragmentCount
+		|| length != int(qMin(frameSize - quint32(index) * MULTICAST_FRAGMENT_SIZE, quint32(MULTICAST_FRAGMENT_SIZE))))
+	{
+		return false;
+	}
+
+	// a restarted publisher counts from 0 again, none of its frames is outdated
+	if (session != _session)
+	{
+		_session         = session;
+		_assembling      = false;
+		_hasLastSequence = false;
+	}
+
+	// fragment of a frame which is already shown or superseded
+	if (_hasLastSequence && isOutdated(sequence, _lastSequence))
+	{
+		return false;
+	}
+
+	if (!_assembling || sequence != _sequence)
+	{
+		// fragment of an older incomplete frame
+		if (_assembling && isOutdated(sequence, _sequence))
+		{
+			return false;
+		}
+
+		// a newer frame drops the incomplete one, it is accounted as lost on completion
+		startFrame(sequence, fragmentCount, int(frameSize));
+	}
+	else if (fragmentCount != _fragmentCount || int(frameSize) != _frameSize)
+	{
+		return false;
+	}
+
+	if (_received[index])
+	{
+		return false;
+	}
+
+	memcpy(_assembly.data() + index * MULTICAST_FRAGMENT_SIZE, data + MULTICAST_HEADER_SIZE, length);
+	_received[index] = true;
+	if (++_receivedCount < _fragmentCount)
+	{
+		return false;
+	}
+
+	// frames skipped since the last complete one of the session
+	if (_hasLastSequence)
+	{
+		const qint32 skipped = qint32(sequence - _lastSequence) - 1;
+		if (skipped > 0)
+		{
+			_lostFrames += quint64(skipped);
+		}
+	}
+
+	setFrame(_assembly.data(), _frameSize);
+	_lastSequence    = sequence;
+	_hasLastSequence = true;
+	_assembling      = false;
+	++_completedFrames;
+	return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// project includes
+#include "UdpDecoder.h"
+
+///
+/// Frames published by the MulticastPublisher of a forwarder. The fragments of a frame are reassembled by
+/// their index, a fragment of a newer frame drops the incomplete one. Outdated and duplicate fragments are ignored,
+/// a new session of the publisher resets the sequence tracking.
+///
+class UdpDecoderMulticast : public UdpDecoder
+{
+public:
+	UdpDecoderMulticast();
+
+	virtual bool decode(const uint8_t* data, const qint64& size);
+
+	///
+	/// @return The number of completed frames
+	///
+	quint64 getCompletedFrames() const { return _completedFrames; }
+
+	///
+	/// @return The number of frames which have been lost or completed too late, by their sequence numbers
+	///
+	quint64 getLostFrames() const { return _lostFrames; }
+
+private:
+	///
+	/// @brief Start the assembly of a frame
+	///
+	void startFrame(quint32 sequence, int fragmentCount, int frameSize);
+
+	/// Frame under assembly
+	std::vector<uint8_t> _assembly;
+
+	/// Received flag of each fragment of the frame under assembly
+	std::vector<bool> _received;
+
+	/// Sequence number, fragment count and size of the frame under assembly
+	quint32 _sequence;
+	int _fragmentCount;
+	int _frameSize;
+	int _receivedCount;
+	bool _assembling;
+
+	/// Session of the publisher, the sequence numbers are compared within a session only
+	quint32 _session;
+
+	/// Sequence number of the newest completed frame
+	quint32 _lastSequence;
+	bool _hasLastSequence;
+
+	quint64 _completedFrames;
+	quint64 _lostFrames;
+};
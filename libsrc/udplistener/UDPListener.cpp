@@ -1,5 +1,9 @@
+// system includes
+#include <cstring>
+
 // project includes
 #include <udplistener/UDPListener.h>
+#include "UdpDecoder.h"
 
 // hyperion includes
 #include <bonjour/bonjourserviceregister.h>
@@ -7,6 +11,7 @@
 // hyperion util includes
 #include "HyperionConfig.h"
 #include <utils/NetOrigin.h>
+#include <utils/MetricsRegistry.h>
 
 // qt includes
 #include <QUdpSocket>
@@ -14,6 +19,12 @@
 
 using namespace hyperion;
 
+// largest possible UDP payload (IPv4)
+const int MAX_DATAGRAM_SIZE = 65507;
+
+// decoders preallocate whole frames, datagrams of further senders are ignored until idle ones are removed
+const int MAX_SENDERS = 64;
+
 UDPListener::UDPListener(const QJsonDocument& config) :
 	QObject(),
 	_server(new QUdpSocket(this)),
@@ -22,10 +33,14 @@ UDPListener::UDPListener(const QJsonDocument& config) :
 	_log(Logger::getInstance("UDPLISTENER")),
 	_isActive(false),
 	_listenPort(0),
-	_netOrigin(NetOrigin::getInstance())
+	_netOrigin(NetOrigin::getInstance()),
+	_datagramBuffer(MAX_DATAGRAM_SIZE, 0)
 {
 	Debug(_log, "Instance created");
 
+	connect(_server, &QUdpSocket::readyRead, this, &UDPListener::readPendingDatagrams);
+	_clock.start();
+
 	// init
 	handleSettingsUpdate(settings::UDPLISTENER, config);
 }
@@ -35,6 +50,7 @@ UDPListener::~UDPListener()
 	// clear the current channel
 	stop();
 	delete _server;
+	qDeleteAll(_decoders);
 }
 
 
@@ -83,6 +99,11 @@ void UDPListener::stop()
 
 	_server->close();
 	_isActive = false;
+	_registeredSender.clear();
+	qDeleteAll(_decoders);
+	_decoders.clear();
+	_lastDatagram.clear();
+	_senderLimitReached = false;
 	Info(_log, "Stopped");
 	emit clearGlobalPriority(_priority, hyperion::COMP_UDPLISTENER);
 }
@@ -107,36 +128,90 @@ uint16_t UDPListener::getPort() const
 
 void UDPListener::readPendingDatagrams()
 {
-	while (_server->hasPendingDatagrams()) {
-		QByteArray datagram;
-		datagram.resize(_server->pendingDatagramSize());
-		QHostAddress sender;
-		quint16 senderPort;
+	QHostAddress sender;
+	quint16 senderPort;
 
-		_server->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+	// drain the socket, each sender keeps only its newest frame
+	while (_server->hasPendingDatagrams())
+	{
+		const qint64 size = _server->readDatagram(_datagramBuffer.data(), _datagramBuffer.size(), &sender, &senderPort);
 
-		if(_netOrigin->accessAllowed(sender, _listenAddress))
-			processTheDatagram(&datagram, &sender);
+		if (size > 0 && _netOrigin->accessAllowed(sender, _listenAddress))
+			processTheDatagram(_datagramBuffer.constData(), size, sender);
 	}
-}
 
+	for (const auto& pendingSender : _pendingSenders)
+	{
+		forwardFrame(pendingSender, _decoders.value(pendingSender)->getFrame());
+	}
+	_pendingSenders.clear();
+}
 
-void UDPListener::processTheDatagram(const QByteArray * datagram, const QHostAddress * sender)
+void UDPListener::processTheDatagram(const char* data, const qint64& size, const QHostAddress& sender)
 {
-	int packetLedCount = datagram->size()/3;
-	//DebugIf( (packetLedCount != hyperionLedCount), _log, "packetLedCount (%d) != hyperionLedCount (%d)", packetLedCount, hyperionLedCount);
+	const qint64 now = _clock.elapsed();
+	if (now - _lastIdleCheck >= _timeout)
+	{
+		removeIdleSenders(now);
+	}
+
+	UdpDecoder* decoder = _decoders.value(sender);
+	if (decoder == nullptr)
+	{
+		if (_decoders.size() >= MAX_SENDERS)
+		{
+			WarningIf(!_senderLimitReached, _log, "More than %d senders, ignoring %s", MAX_SENDERS, QSTRING_CSTR(sender.toString()));
+			_senderLimitReached = true;
+			return;
+		}
+
+		decoder = UdpDecoder::construct(_protocol, _config);
+		_decoders.insert(sender, decoder);
+		Debug(_log, "New %s sender %s", QSTRING_CSTR(_protocol), QSTRING_CSTR(sender.toString()));
+	}
+	_lastDatagram[sender] = now;
+
+	if (decoder->decode(reinterpret_cast<const uint8_t*>(data), size))
+	{
+		// a newer frame of the same read replaces the pending one
+		if (_pendingSenders.contains(sender))
+			MetricsRegistry::add(MetricsRegistry::DROPPED_UDP);
+		else
+			_pendingSenders.append(sender);
+	}
+}
 
-	std::vector<ColorRgb> _ledColors(packetLedCount, ColorRgb::BLACK);
+void UDPListener::removeIdleSenders(qint64 now)
+{
+	for (auto it = _lastDatagram.begin(); it != _lastDatagram.end();)
+	{
+		// the frame of a pending sender is forwarded after the read
+		if (now - it.value() >= _timeout && !_pendingSenders.contains(it.key()))
+		{
+			Debug(_log, "Remove idle sender %s", QSTRING_CSTR(it.key().toString()));
+			delete _decoders.take(it.key());
+			it = _lastDatagram.erase(it);
+			_senderLimitReached = false;
+		}
+		else
+		{
+			++it;
+		}
+	}
+	_lastIdleCheck = now;
+}
 
-	for (int ledIndex=0; ledIndex < packetLedCount; ledIndex++) {
-		ColorRgb & rgb =  _ledColors[ledIndex];
-		rgb.red   = datagram->at(ledIndex*3+0);
-		rgb.green = datagram->at(ledIndex*3+1);
-		rgb.blue  = datagram->at(ledIndex*3+2);
+void UDPListener::forwardFrame(const QHostAddress& sender, const std::vector<ColorRgb>& ledColors)
+{
+	// register again when the sender changed or the input might have reached the muxer timeout
+	if (sender != _registeredSender || !_lastFrameTimer.isValid() || _lastFrameTimer.elapsed() >= _timeout)
+	{
+		emit registerGlobalInput(_priority, hyperion::COMP_UDPLISTENER, QString("UDPListener@%1").arg(sender.toString()));
+		_registeredSender = sender;
 	}
-	// TODO provide a setInput with origin arg to overwrite senders smarter
-	emit registerGlobalInput(_priority, hyperion::COMP_UDPLISTENER, QString("UDPListener@%1").arg(sender->toString()));
-	emit setGlobalInput(_priority, _ledColors, _timeout);
+
+	emit setGlobalInput(_priority, ledColors, _timeout);
+	_lastFrameTimer.start();
 }
 
 void UDPListener::handleSettingsUpdate(const settings::type& type, const QJsonDocument& config)
@@ -153,6 +228,8 @@ void UDPListener::handleSettingsUpdate(const settings::type& type, const QJsonDo
 		_listenAddress = addr.isEmpty()? QHostAddress::AnyIPv4 : QHostAddress(addr);
 		_bondage = (obj["shared"].toBool(false)) ? QAbstractSocket::ShareAddress : QAbstractSocket::DefaultForPlatform;
 		_timeout = obj["timeout"].toInt(10000);
+		_protocol = obj["protocol"].toString("raw");
+		_config = obj;
 		if(obj["enable"].toBool())
 			start();
 	}
@@ -0,0 +1,30 @@
+// system includes
+#include <cstring>
+
+// project includes
+#include "UdpDecoder.h"
+#include "DmxDecoder.h"
+#include "DdpDecoder.h"
+#include "MulticastDecoder.h"
+
+UdpDecoder* UdpDecoder::construct(const QString& protocol, const QJsonObject& config)
+{
+	if (protocol == "e131")   return new UdpDecoderE131(config);
+	if (protocol == "artnet") return new UdpDecoderArtNet(config);
+	if (protocol == "ddp")    return new UdpDecoderDdp();
+	if (protocol == "multicast") return new UdpDecoderMulticast();
+
+	return new UdpDecoderRaw();
+}
+
+void UdpDecoder::setFrame(const uint8_t* data, const int& size)
+{
+	_frame.resize(size/3);
+	memcpy(_frame.data(), data, _frame.size() * sizeof(ColorRgb));
+}
+
+bool UdpDecoderRaw::decode(const uint8_t* data, const qint64& size)
+{
+	setFrame(data, qMin(size, qint64(UDP_MAX_FRAME_SIZE)));
+	return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// stl includes
+#include <vector>
+#include <cstdint>
+
+// Qt includes
+#include <QString>
+#include <QJsonObject>
+
+// utils includes
+#include <utils/ColorRgb.h>
+
+/// Upper limit of a reassembled frame in bytes (~43k leds), protects against bogus offsets
+#define UDP_MAX_FRAME_SIZE 131072
+
+///
+/// Base class of the UDPListener protocol decoders. A decoder is created per sender and
+/// assembles its datagrams into complete led frames
+///
+class UdpDecoder
+{
+public:
+	virtual ~UdpDecoder() {};
+
+	///
+	/// @brief Decode a datagram of the sender
+	/// @param data  The datagram payload
+	/// @param size  The payload size in bytes
+	/// @return True if a frame has been completed with this datagram
+	///
+	virtual bool decode(const uint8_t* data, const qint64& size) = 0;
+
+	///
+	/// @brief Get the newest complete frame
+	/// @return The led colors
+	///
+	const std::vector<ColorRgb>& getFrame() const { return _frame; };
+
+	///
+	/// @brief Create the decoder for the given protocol
+	/// @param protocol  The protocol name (raw, e131, artnet, ddp, multicast)
+	/// @param config    The udpListener configuration
+	/// @return The decoder, falls back to raw on unknown protocols
+	///
+	static UdpDecoder* construct(const QString& protocol, const QJsonObject& config);
+
+protected:
+	///
+	/// @brief Publish the first bytes of an assembly buffer as new frame, without reallocation if the size is stable
+	/// @param data  The rgb bytes
+	/// @param size  The size in bytes
+	///
+	void setFrame(const uint8_t* data, const int& size);
+
+	/// The newest complete frame
+	std::vector<ColorRgb> _frame;
+};
+
+///
+/// Raw rgb triples, each datagram is a complete frame
+///
+class UdpDecoderRaw : public UdpDecoder
+{
+public:
+	virtual bool decode(const uint8_t* data, const qint64& size);
+};
@@ -1,5 +1,7 @@
 #include <utils/ColorSys.h>
 
+#include <cmath>
+
 #include <QColor>
 void ColorSys::rgb2hsl(uint8_t red, uint8_t green, uint8_t blue, uint16_t & hue, float & saturation, float & luminance)
 {
@@ -34,3 +36,31 @@ void ColorSys::hsv2rgb(uint16_t hue, uint8_t saturation, uint8_t value, uint8_t
 	green = (uint8_t)color.green();
 	blue  = (uint8_t)color.blue();
 }
+
+void ColorSys::hsv2rgb(double hue, double saturation, double value, uint8_t & red, uint8_t & green, uint8_t & blue)
+{
+	hue -= std::floor(hue);
+	saturation = qBound(0.0, saturation, 1.0);
+	value = qBound(0.0, value, 1.0);
+
+	const int sector = int(hue * 6.0);
+	const double f = hue * 6.0 - sector;
+	const double p = value * (1.0 - saturation);
+	const double q = value * (1.0 - saturation * f);
+	const double t = value * (1.0 - saturation * (1.0 - f));
+
+	double r, g, b;
+	switch (sector % 6)
+	{
+		case 0:  r = value; g = t;     b = p;     break;
+		case 1:  r = q;     g = value; b = p;     break;
+		case 2:  r = p;     g = value; b = t;     break;
+		case 3:  r = p;     g = q;     b = value; break;
+		case 4:  r = t;     g = p;     b = value; break;
+		default: r = value; g = p;     b = q;     break;
+	}
+
+	red   = uint8_t(r * 255.0);
+	green = uint8_t(g * 255.0);
+	blue  = uint8_t(b * 255.0);
+}
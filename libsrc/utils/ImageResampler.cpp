@@ -1,5 +1,6 @@
 #include "utils/ImageResampler.h"
 #include <utils/Logger.h>
+#include <utils/LatencyTracer.h>
 
 ImageResampler::ImageResampler()
 	: _horizontalDecimation(1)
@@ -41,6 +42,8 @@ void ImageResampler::setVideoMode(VideoMode mode)
 
 void ImageResampler::processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> &outputImage) const
 {
+	LatencyScope latency(LatencyTracer::RESAMPLE);
+
 	int cropLeft   = _cropLeft;
 	int cropRight  = _cropRight;
 	int cropTop    = _cropTop;
@@ -0,0 +1,177 @@
+// STL includes
+#include <atomic>
+#include <chrono>
+
+// Qt includes
+#include <QJsonArray>
+
+// project includes
+#include <utils/LatencyTracer.h>
+
+namespace {
+
+	const char* STAGE_NAMES[LatencyTracer::STAGE_COUNT] = {
+		"grab", "resample", "mux", "map", "adjust", "smooth", "write", "endToEnd"
+	};
+
+	struct Histogram
+	{
+		std::atomic<uint64_t> sum;
+		std::atomic<int64_t> max;
+		std::atomic<uint64_t> buckets[LatencyTracer::BUCKETS];
+	};
+
+	// zero initialized as static storage
+	Histogram histograms[LatencyTracer::STAGE_COUNT];
+
+	/// Capture time of the newest frame which hasn't been written yet, 0 if none
+	std::atomic<int64_t> captureTime;
+
+	/// Component which marked the capture time
+	std::atomic<int> captureComponent;
+
+	inline int bucketIndex(int64_t duration)
+	{
+		uint64_t us = uint64_t(duration) / 1000;
+		int index = 0;
+		while (us != 0 && index < LatencyTracer::BUCKETS - 1)
+		{
+			us >>= 1;
+			++index;
+		}
+		return index;
+	}
+
+	/// @return The upper bound in us of the bucket which holds the given fraction of the samples
+	double percentile(const uint64_t* buckets, uint64_t count, double fraction, double maxUs)
+	{
+		const uint64_t rank = uint64_t(fraction * count + 0.5);
+		uint64_t seen = 0;
+		for (int i = 0; i < LatencyTracer::BUCKETS; ++i)
+		{
+			seen += buckets[i];
+			if (seen >= rank && seen > 0)
+			{
+				return qMin(double(uint64_t(1) << i), maxUs);
+			}
+		}
+		return maxUs;
+	}
+}
+
+int64_t LatencyTracer::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyTracer::record(Stage stage, int64_t duration)
+{
+	if (duration < 0)
+	{
+		return;
+	}
+
+	Histogram& histogram = histograms[stage];
+	histogram.sum.fetch_add(uint64_t(duration), std::memory_order_relaxed);
+	histogram.buckets[bucketIndex(duration)].fetch_add(1, std::memory_order_relaxed);
+
+	int64_t max = histogram.max.load(std::memory_order_relaxed);
+	while (duration > max && !histogram.max.compare_exchange_weak(max, duration, std::memory_order_relaxed))
+	{
+	}
+}
+
+void LatencyTracer::markCapture(int64_t timestamp, hyperion::Components component)
+{
+	captureComponent.store(component, std::memory_order_relaxed);
+	captureTime.store(timestamp, std::memory_order_relaxed);
+}
+
+void LatencyTracer::discardCapture(hyperion::Components component)
+{
+	// an input of another component must not discard the mark of the visible capture
+	int64_t timestamp = captureTime.load(std::memory_order_relaxed);
+	if (timestamp != 0 && captureComponent.load(std::memory_order_relaxed) == component)
+	{
+		captureTime.compare_exchange_strong(timestamp, 0, std::memory_order_relaxed);
+	}
+}
+
+void LatencyTracer::markWrite()
+{
+	const int64_t timestamp = captureTime.exchange(0, std::memory_order_relaxed);
+	if (timestamp != 0)
+	{
+		record(END_TO_END, now() - timestamp);
+	}
+}
+
+const char* LatencyTracer::stageName(Stage stage)
+{
+	return STAGE_NAMES[stage];
+}
+
+void LatencyTracer::getHistogram(Stage stage, uint64_t* buckets, uint64_t& sum)
+{
+	const Histogram& histogram = histograms[stage];
+	for (int i = 0; i < BUCKETS; ++i)
+	{
+		buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+	}
+	sum = histogram.sum.load(std::memory_order_relaxed);
+}
+
+QJsonObject LatencyTracer::getMetrics()
+{
+	QJsonArray bucketBounds;
+	for (int i = 0; i < BUCKETS - 1; ++i)
+	{
+		bucketBounds.append(double(uint64_t(1) << i));
+	}
+
+	QJsonObject stages;
+	for (int stage = 0; stage < STAGE_COUNT; ++stage)
+	{
+		// a snapshot, samples recorded meanwhile may be missing in some of the values
+		uint64_t buckets[BUCKETS];
+		uint64_t sum;
+		getHistogram(Stage(stage), buckets, sum);
+
+		uint64_t count = 0;
+		QJsonArray bucketCounts;
+		for (int i = 0; i < BUCKETS; ++i)
+		{
+			count += buckets[i];
+			bucketCounts.append(double(buckets[i]));
+		}
+
+		const double maxUs = histograms[stage].max.load(std::memory_order_relaxed) / 1000.0;
+		QJsonObject metrics;
+		metrics["count"]     = double(count);
+		metrics["avgUs"]     = (count > 0) ? sum / 1000.0 / count : 0.0;
+		metrics["maxUs"]     = maxUs;
+		metrics["p50Us"]     = percentile(buckets, count, 0.50, maxUs);
+		metrics["p90Us"]     = percentile(buckets, count, 0.90, maxUs);
+		metrics["p99Us"]     = percentile(buckets, count, 0.99, maxUs);
+		metrics["histogram"] = bucketCounts;
+		stages[STAGE_NAMES[stage]] = metrics;
+	}
+
+	QJsonObject result;
+	result["bucketBoundsUs"] = bucketBounds;
+	result["stages"] = stages;
+	return result;
+}
+
+void LatencyTracer::reset()
+{
+	for (Histogram& histogram : histograms)
+	{
+		histogram.sum.store(0, std::memory_order_relaxed);
+		histogram.max.store(0, std::memory_order_relaxed);
+		for (auto& bucket : histogram.buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+}
@@ -3,19 +3,235 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <syslog.h>
 #include <QFileInfo>
+#include <QThread>
+#include <QSemaphore>
 #include <time.h>
 
+/// Number of records in the ring of the background writer, a power of two
+static const size_t LOG_RING_SIZE = 256;
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE has to be a power of two");
+
+/// Maximum length of a formatted message
+static const size_t LOG_MESSAGE_LENGTH = 1024;
+
 static const char * LogLevelStrings[]   = { "", "DEBUG", "INFO", "WARNING", "ERROR" };
 static const int    LogLevelSysLog[]    = { LOG_DEBUG, LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERR };
 static unsigned int loggerCount         = 0;
 static unsigned int loggerId            = 0;
 
 std::map<QString,Logger*> *Logger::LoggerMap = nullptr;
-Logger::LogLevel Logger::GLOBAL_MIN_LOG_LEVEL = Logger::UNSET;
+std::atomic<int> Logger::GLOBAL_MIN_LOG_LEVEL(Logger::UNSET);
 LoggerManager* LoggerManager::_instance = nullptr;
 
+///
+/// Writes the messages of all loggers in a background thread. The calling threads format their message
+/// into a record of a bounded lock free ring, which the writer takes in batches to write the console lines
+/// with a single flush, send them to syslog and emit them to the LoggerManager. An idle writer sleeps on a
+/// doorbell, which the first record published after it went to sleep rings.
+///
+class LogWriter : public QThread
+{
+public:
+	/// A formatted message, the sequence tells the producers and the writer whether it is free or published
+	struct Record
+	{
+		std::atomic<size_t> sequence;
+		size_t              position;
+		Logger*             logger;
+		Logger::LogLevel    level;
+		const char*         sourceFile;
+		const char*         func;
+		unsigned int        line;
+		time_t              utime;
+		char                message[LOG_MESSAGE_LENGTH];
+	};
+
+	///
+	/// @return The writer, started on the first call and stopped on exit
+	///
+	static LogWriter* getInstance()
+	{
+		static LogWriter* writer = []
+		{
+			LogWriter* instance = new LogWriter();
+			instance->start();
+			std::atexit([] { LogWriter::getInstance()->stop(); });
+			return instance;
+		}();
+		return writer;
+	}
+
+	///
+	/// @return Whether messages are written by the background thread
+	///
+	bool isActive() const
+	{
+		return !_stop.load(std::memory_order_acquire);
+	}
+
+	///
+	/// @return A record to fill and publish, nullptr if the ring is full
+	///
+	Record* acquire()
+	{
+		size_t position = _enqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Record& record = _ring[position & (LOG_RING_SIZE - 1)];
+			const size_t sequence = record.sequence.load(std::memory_order_acquire);
+			const intptr_t diff = intptr_t(sequence) - intptr_t(position);
+			if (diff == 0)
+			{
+				if (_enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					record.position = position;
+					return &record;
+				}
+			}
+			else if (diff < 0)
+			{
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			else
+			{
+				position = _enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	///
+	/// @brief Hand a filled record over to the writer
+	///
+	void publish(Record* record)
+	{
+		record->sequence.store(record->position + 1, std::memory_order_release);
+
+		// pairs with the fence of the writer, either it sees the record or we see it sleeping
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_sleeping.load(std::memory_order_relaxed) && _sleeping.exchange(false, std::memory_order_relaxed))
+		{
+			_doorbell.release();
+		}
+	}
+
+	///
+	/// @brief Wait until the records acquired so far have been written
+	///
+	void flush()
+	{
+		const size_t target = _enqueuePos.load(std::memory_order_relaxed);
+		while (isActive() && _dequeuePos.load(std::memory_order_acquire) < target)
+		{
+			QThread::msleep(1);
+		}
+	}
+
+	///
+	/// @brief Write the remaining records and stop the thread, later messages are written by the caller
+	///
+	void stop()
+	{
+		if (_stop.exchange(true))
+			return;
+
+		_doorbell.release();
+		wait();
+		drain();
+	}
+
+protected:
+	void run() override
+	{
+		while (isActive())
+		{
+			if (drain())
+				continue;
+
+			_sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!isPending() && isActive())
+			{
+				_doorbell.acquire();
+			}
+			_sleeping.store(false, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	LogWriter()
+		: QThread()
+		, _enqueuePos(0)
+		, _dequeuePos(0)
+		, _stop(false)
+		, _dropped(0)
+		, _sleeping(false)
+		, _doorbell()
+	{
+		for (size_t i = 0; i < LOG_RING_SIZE; ++i)
+		{
+			_ring[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	///
+	/// @return True if the next record has been published
+	///
+	bool isPending() const
+	{
+		const size_t position = _dequeuePos.load(std::memory_order_relaxed);
+		return _ring[position & (LOG_RING_SIZE - 1)].sequence.load(std::memory_order_acquire) == position + 1;
+	}
+
+	///
+	/// @brief Write all published records
+	/// @return False if there were none
+	///
+	bool drain()
+	{
+		std::string output;
+		size_t position = _dequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Record& record = _ring[position & (LOG_RING_SIZE - 1)];
+			if (record.sequence.load(std::memory_order_acquire) != position + 1)
+				break;
+
+			record.logger->write(record.level, record.sourceFile, record.func, record.line, record.utime, record.message, output);
+
+			// release the record for the lap of the producers
+			record.sequence.store(position + LOG_RING_SIZE, std::memory_order_release);
+			_dequeuePos.store(++position, std::memory_order_release);
+		}
+
+		const uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped > 0)
+		{
+			output += "[LOGGER] <WARNING> " + std::to_string(dropped) + " messages dropped, the log queue was full\n";
+		}
+
+		if (output.empty())
+			return false;
+
+		std::cout << output << std::flush;
+		return true;
+	}
+
+	Record                _ring[LOG_RING_SIZE];
+	std::atomic<size_t>   _enqueuePos;
+	std::atomic<size_t>   _dequeuePos;
+	std::atomic<bool>     _stop;
+	std::atomic<uint64_t> _dropped;
+
+	/// Set by the writer before it sleeps on the doorbell, the producer which clears it rings
+	std::atomic<bool>     _sleeping;
+	QSemaphore            _doorbell;
+};
+
 Logger* Logger::getInstance(QString name, Logger::LogLevel minLevel)
 {
 	qRegisterMetaType<Logger::T_LOG_MESSAGE>();
@@ -47,6 +263,9 @@ void Logger::deleteInstance(QString name)
 
 	if ( name.isEmpty() )
 	{
+		// the queued records refer to the loggers
+		LogWriter::getInstance()->stop();
+
 		std::map<QString,Logger*>::iterator it;
 		for ( it=LoggerMap->begin(); it != LoggerMap->end(); it++)
 		{
@@ -56,6 +275,7 @@ void Logger::deleteInstance(QString name)
 	}
 	else if (LoggerMap->find(name) != LoggerMap->end())
 	{
+		flush();
 		delete LoggerMap->at(name);
 		LoggerMap->erase(name);
 	}
@@ -75,11 +295,16 @@ void Logger::setLogLevel(LogLevel level,QString name)
 	}
 }
 
+void Logger::flush()
+{
+	LogWriter::getInstance()->flush();
+}
+
 Logger::LogLevel Logger::getLogLevel(QString name)
 {
 	if ( name.isEmpty() )
 	{
-		return GLOBAL_MIN_LOG_LEVEL;
+		return LogLevel(GLOBAL_MIN_LOG_LEVEL.load());
 	}
 
 	Logger* log = Logger::getInstance(name);
@@ -120,17 +345,48 @@ Logger::~Logger()
 
 void Logger::Message(LogLevel level, const char* sourceFile, const char* func, unsigned int line, const char* fmt, ...)
 {
-	if ( (GLOBAL_MIN_LOG_LEVEL == Logger::UNSET && level < _minLevel) // no global level, use level from logger
-	  || (GLOBAL_MIN_LOG_LEVEL > Logger::UNSET && level < GLOBAL_MIN_LOG_LEVEL) ) // global level set, use global level
+	// the macros check it already, direct callers like the profiler don't
+	if (!isEnabled(level))
 		return;
 
-	const size_t max_msg_length = 1024;
-	char msg[max_msg_length];
 	va_list args;
+	LogWriter* writer = LogWriter::getInstance();
+	if (writer->isActive())
+	{
+		// format into the ring, a full ring drops the message instead of blocking the caller
+		LogWriter::Record* record = writer->acquire();
+		if (record == nullptr)
+			return;
+
+		va_start (args, fmt);
+		vsnprintf (record->message, LOG_MESSAGE_LENGTH, fmt, args);
+		va_end (args);
+
+		record->logger     = this;
+		record->level      = level;
+		record->sourceFile = sourceFile;
+		record->func       = func;
+		record->line       = line;
+		time(&(record->utime));
+		writer->publish(record);
+		return;
+	}
+
+	// the writer has been stopped on exit
+	char msg[LOG_MESSAGE_LENGTH];
 	va_start (args, fmt);
-	vsnprintf (msg, max_msg_length, fmt, args);
+	vsnprintf (msg, LOG_MESSAGE_LENGTH, fmt, args);
 	va_end (args);
 
+	time_t utime;
+	time(&utime);
+	std::string output;
+	write(level, sourceFile, func, line, utime, msg, output);
+	std::cout << output << std::flush;
+}
+
+void Logger::write(LogLevel level, const char* sourceFile, const char* func, unsigned int line, time_t utime, const char* msg, std::string& output)
+{
 	Logger::T_LOG_MESSAGE logMsg;
 
 	logMsg.appName     = _appname;
@@ -138,7 +394,7 @@ void Logger::Message(LogLevel level, const char* sourceFile, const char* func, u
 	logMsg.function    = QString(func);
 	logMsg.line        = line;
 	logMsg.fileName    = FileUtils::getBaseName(sourceFile);
-	time(&(logMsg.utime));
+	logMsg.utime       = utime;
 	logMsg.message     = QString(msg);
 	logMsg.level       = level;
 	logMsg.levelString = LogLevelStrings[level];
@@ -151,7 +407,8 @@ void Logger::Message(LogLevel level, const char* sourceFile, const char* func, u
 		location = "<" + logMsg.fileName + ":" + QString::number(line)+":"+ logMsg.function + "()> ";
 	}
 
-	std::cout << QString("[" + _appname + " " + _name + "] <" + LogLevelStrings[level] + "> " + location + msg).toStdString() << std::endl;
+	output += QString("[" + _appname + " " + _name + "] <" + LogLevelStrings[level] + "> " + location + msg).toStdString();
+	output += '\n';
 
 	if ( _syslogEnabled && level >= Logger::WARNING )
 		syslog (LogLevelSysLog[level], "%s", msg);
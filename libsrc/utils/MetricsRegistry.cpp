@@ -0,0 +1,60 @@
+// STL includes
+#include <atomic>
+
+// system includes
+#include <time.h>
+
+// project includes
+#include <utils/MetricsRegistry.h>
+
+namespace {
+	// zero initialized as static storage
+	std::atomic<uint64_t> counters[MetricsRegistry::COUNTER_COUNT];
+	std::atomic<int64_t> gauges[MetricsRegistry::GAUGE_COUNT];
+	std::atomic<uint64_t> priorityFrames[256];
+}
+
+void MetricsRegistry::add(Counter counter, uint64_t value)
+{
+	counters[counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t MetricsRegistry::get(Counter counter)
+{
+	return counters[counter].load(std::memory_order_relaxed);
+}
+
+void MetricsRegistry::set(Gauge gauge, int64_t value)
+{
+	gauges[gauge].store(value, std::memory_order_relaxed);
+}
+
+int64_t MetricsRegistry::get(Gauge gauge)
+{
+	return gauges[gauge].load(std::memory_order_relaxed);
+}
+
+void MetricsRegistry::addPriorityFrame(int priority)
+{
+	if (priority >= 0 && priority < 256)
+	{
+		priorityFrames[priority].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+uint64_t MetricsRegistry::getPriorityFrames(int priority)
+{
+	return (priority >= 0 && priority < 256) ? priorityFrames[priority].load(std::memory_order_relaxed) : 0;
+}
+
+int64_t MetricsRegistry::threadCpuTime()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec time;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0)
+	{
+		return int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+	}
+#endif
+	return 0;
+}
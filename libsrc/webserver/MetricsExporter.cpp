@@ -0,0 +1,163 @@
+#include "MetricsExporter.h"
+
+// system includes
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Qt includes
+#include <QFile>
+
+// hyperion includes
+#include <hyperion/Hyperion.h>
+#include <utils/Components.h>
+#include <utils/LatencyTracer.h>
+#include <utils/MetricsRegistry.h>
+
+const char* MetricsExporter::CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+namespace {
+
+	void family(QByteArray& out, const char* name, const char* type, const char* help)
+	{
+		out.append("# HELP ").append(name).append(' ').append(help).append('\n');
+		out.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+	}
+
+	void sample(QByteArray& out, const QByteArray& name, const QByteArray& labels, const QByteArray& value)
+	{
+		out.append(name);
+		if (!labels.isEmpty())
+		{
+			out.append('{').append(labels).append('}');
+		}
+		out.append(' ').append(value).append('\n');
+	}
+
+	inline QByteArray seconds(double ns)
+	{
+		return QByteArray::number(ns / 1e9, 'g', 12);
+	}
+
+	void renderPriorities(QByteArray& out)
+	{
+		Hyperion* hyperion = Hyperion::getInstance();
+
+		family(out, "hyperion_priority_frames_total", "counter", "Inputs received by the registered priorities");
+		for (int priority : hyperion->getActivePriorities())
+		{
+			if (priority == PriorityMuxer::LOWEST_PRIORITY)
+			{
+				continue;
+			}
+
+			const Hyperion::InputInfo& info = hyperion->getPriorityInfo(priority);
+			const QByteArray labels = "priority=\"" + QByteArray::number(priority)
+				+ "\",component=\"" + hyperion::componentToIdString(info.componentId) + "\"";
+			sample(out, "hyperion_priority_frames_total", labels, QByteArray::number(qulonglong(MetricsRegistry::getPriorityFrames(priority))));
+		}
+
+		family(out, "hyperion_visible_priority", "gauge", "The visible priority");
+		sample(out, "hyperion_visible_priority", QByteArray(), QByteArray::number(hyperion->getCurrentPriority()));
+	}
+
+	void renderRegistry(QByteArray& out)
+	{
+		static const struct { MetricsRegistry::Counter counter; const char* stage; } DROPPED[] = {
+			{ MetricsRegistry::DROPPED_EFFECT,    "effect" },
+			{ MetricsRegistry::DROPPED_UDP,       "udp" },
+			{ MetricsRegistry::DROPPED_FORWARDER, "forwarder" },
+			{ MetricsRegistry::DROPPED_LATCH,     "latch" }
+		};
+
+		family(out, "hyperion_frames_dropped_total", "counter", "Frames replaced by a newer one before they were processed");
+		for (const auto& dropped : DROPPED)
+		{
+			sample(out, "hyperion_frames_dropped_total", QByteArray("stage=\"") + dropped.stage + "\"",
+				QByteArray::number(qulonglong(MetricsRegistry::get(dropped.counter))));
+		}
+
+		family(out, "hyperion_device_write_errors_total", "counter", "Failed writes of the led device");
+		sample(out, "hyperion_device_write_errors_total", QByteArray(),
+			QByteArray::number(qulonglong(MetricsRegistry::get(MetricsRegistry::DEVICE_WRITE_ERRORS))));
+
+		family(out, "hyperion_smoothing_queue_depth", "gauge", "Frames in the output delay queue of the smoothing");
+		sample(out, "hyperion_smoothing_queue_depth", QByteArray(),
+			QByteArray::number(qlonglong(MetricsRegistry::get(MetricsRegistry::SMOOTHING_QUEUE_DEPTH))));
+
+		family(out, "hyperion_effect_cpu_seconds_total", "counter", "CPU time of the effect threads");
+		sample(out, "hyperion_effect_cpu_seconds_total", QByteArray(),
+			seconds(double(MetricsRegistry::get(MetricsRegistry::EFFECT_CPU_NS))));
+	}
+
+	void renderLatency(QByteArray& out)
+	{
+		family(out, "hyperion_stage_latency_seconds", "histogram", "Duration of the stages of the pipeline");
+		for (int stage = 0; stage < LatencyTracer::STAGE_COUNT; ++stage)
+		{
+			uint64_t buckets[LatencyTracer::BUCKETS];
+			uint64_t sum;
+			LatencyTracer::getHistogram(LatencyTracer::Stage(stage), buckets, sum);
+
+			const QByteArray stageLabel = QByteArray("stage=\"") + LatencyTracer::stageName(LatencyTracer::Stage(stage)) + "\"";
+			uint64_t count = 0;
+			for (int i = 0; i < LatencyTracer::BUCKETS; ++i)
+			{
+				// bucket i holds durations below 2^i us, the last one is unbounded
+				count += buckets[i];
+				const QByteArray bound = (i < LatencyTracer::BUCKETS - 1) ? seconds(double(uint64_t(1) << i) * 1000) : QByteArray("+Inf");
+				sample(out, "hyperion_stage_latency_seconds_bucket", stageLabel + ",le=\"" + bound + "\"", QByteArray::number(qulonglong(count)));
+			}
+			sample(out, "hyperion_stage_latency_seconds_sum", stageLabel, seconds(double(sum)));
+			sample(out, "hyperion_stage_latency_seconds_count", stageLabel, QByteArray::number(qulonglong(count)));
+		}
+	}
+
+	void renderProcess(QByteArray& out)
+	{
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == 0)
+		{
+			const double cpuNs = (double(usage.ru_utime.tv_sec) + double(usage.ru_stime.tv_sec)) * 1e9
+				+ (double(usage.ru_utime.tv_usec) + double(usage.ru_stime.tv_usec)) * 1e3;
+			family(out, "process_cpu_seconds_total", "counter", "Total user and system CPU time spent in seconds");
+			sample(out, "process_cpu_seconds_total", QByteArray(), seconds(cpuNs));
+		}
+
+		// sizes in pages: total program size, resident set size, ...
+		QFile statm("/proc/self/statm");
+		if (statm.open(QIODevice::ReadOnly))
+		{
+			const QList<QByteArray> fields = statm.readAll().simplified().split(' ');
+			if (fields.size() >= 2)
+			{
+				const qulonglong pageSize = qulonglong(sysconf(_SC_PAGESIZE));
+				family(out, "process_virtual_memory_bytes", "gauge", "Virtual memory size in bytes");
+				sample(out, "process_virtual_memory_bytes", QByteArray(), QByteArray::number(fields[0].toULongLong() * pageSize));
+				family(out, "process_resident_memory_bytes", "gauge", "Resident memory size in bytes");
+				sample(out, "process_resident_memory_bytes", QByteArray(), QByteArray::number(fields[1].toULongLong() * pageSize));
+			}
+		}
+		else if (getrusage(RUSAGE_SELF, &usage) == 0)
+		{
+			// the peak is the closest value without procfs, in kilobytes on linux and bytes on macOS
+#ifdef __APPLE__
+			const qulonglong maxRss = qulonglong(usage.ru_maxrss);
+#else
+			const qulonglong maxRss = qulonglong(usage.ru_maxrss) * 1024;
+#endif
+			family(out, "process_max_resident_memory_bytes", "gauge", "Peak resident memory size in bytes");
+			sample(out, "process_max_resident_memory_bytes", QByteArray(), QByteArray::number(maxRss));
+		}
+	}
+}
+
+QByteArray MetricsExporter::render()
+{
+	QByteArray out;
+	out.reserve(16384);
+	renderPriorities(out);
+	renderRegistry(out);
+	renderLatency(out);
+	renderProcess(out);
+	return out;
+}
@@ -0,0 +1,22 @@
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QByteArray>
+
+///
+/// Renders the metrics of the pipeline and the process in the Prometheus text exposition format,
+/// which OpenMetrics scrapers accept as well. Served at /metrics by the web server.
+///
+class MetricsExporter
+{
+public:
+	/// The content type of the rendered metrics
+	static const char* CONTENT_TYPE;
+
+	///
+	/// @return The current metrics, must be called from the thread of Hyperion
+	///
+	static QByteArray render();
+};
+
+#endif // METRICSEXPORTER_H
@@ -1,5 +1,6 @@
 
 #include "StaticFileServing.h"
+#include "MetricsExporter.h"
 
 #include <QStringBuilder>
 #include <QUrlQuery>
@@ -105,6 +106,12 @@ void StaticFileServing::onRequestNeedsReply (QtHttpRequest * request, QtHttpRepl
 				}
 				return;
 			}
+			else if(uri_parts.at(0) == "metrics" && uri_parts.size() == 1)
+			{
+				reply->addHeader ("Content-Type", MetricsExporter::CONTENT_TYPE);
+				reply->appendRawData (MetricsExporter::render());
+				return;
+			}
 			else if(uri_parts.at(0) == "description.xml" && !_ssdpDescription.isNull())
 			{
 				reply->addHeader ("Content-Type", "text/xml");
@@ -195,6 +195,9 @@ void HyperionDaemon::startNetworkServices()
 	// Create UDP listener
 	_udpListener = new UDPListener(getSetting(settings::UDPLISTENER));
 	connect(this, &HyperionDaemon::settingsChanged, _udpListener, &UDPListener::handleSettingsUpdate);
+	connect(_udpListener, &UDPListener::registerGlobalInput, _hyperion, &Hyperion::registerInput);
+	connect(_udpListener, &UDPListener::setGlobalInput, _hyperion, &Hyperion::setInput);
+	connect(_udpListener, &UDPListener::clearGlobalPriority, _hyperion, [=](const int& priority, const hyperion::Components&){ _hyperion->clear(priority); });
 
 	// Create Webserver
 	_webserver = new WebServer(getSetting(settings::WEBSERVER));
@@ -0,0 +1,168 @@
+// STL includes
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QFile>
+
+// Hyperion includes
+#include <utils/ColorRgb.h>
+#include <commandline/Parser.h>
+#include "boblightserver/BoblightParser.h"
+
+using namespace commandline;
+
+/// Session of a kodi boblight client: the setup, then one rgb line per led and a sync per frame
+QByteArray createSession(int leds, int frames)
+{
+	QByteArray session("hello\nget version\nget lights\nset priority 128\n");
+	char line[128];
+	for (int led = 0; led < leds; ++led)
+	{
+		session += QByteArray(line, snprintf(line, sizeof(line), "set light %03d use 1\nset light %03d interpolation 0\n", led, led));
+	}
+
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		for (int led = 0; led < leds; ++led)
+		{
+			const double phase = double((frame * 7 + led * 13) % 1000) / 999.0;
+			session += QByteArray(line, snprintf(line, sizeof(line), "set light %03d rgb %f %f %f\n", led, phase, 1.0 - phase, phase * 0.5));
+		}
+		session += "sync\n";
+	}
+	return session;
+}
+
+/// The rgb lines handled like BoblightClientConnection did with QString
+int handleLegacy(const QByteArray& session, std::vector<ColorRgb>& leds)
+{
+	int rgbLines = 0;
+	int begin = 0;
+	int newline;
+	while ((newline = session.indexOf('\n', begin)) >= 0)
+	{
+		const QString message = QString::fromLatin1(session.constData() + begin, newline - begin).trimmed();
+		begin = newline + 1;
+
+		QStringList messageParts = message.split(" ", QString::SkipEmptyParts);
+		if (messageParts.size() == 7 && messageParts[0] == "set" && messageParts[1] == "light" && messageParts[3] == "rgb")
+		{
+			bool rc, rc1, rc2, rc3;
+			const unsigned ledIndex = messageParts[2].toUInt(&rc);
+			messageParts[4].replace(',', '.');
+			messageParts[5].replace(',', '.');
+			messageParts[6].replace(',', '.');
+			const uint8_t red   = qMax(0, qMin(255, int(255 * messageParts[4].toFloat(&rc1))));
+			const uint8_t green = qMax(0, qMin(255, int(255 * messageParts[5].toFloat(&rc2))));
+			const uint8_t blue  = qMax(0, qMin(255, int(255 * messageParts[6].toFloat(&rc3))));
+			if (rc && rc1 && rc2 && rc3 && ledIndex < leds.size())
+			{
+				leds[ledIndex] = { red, green, blue };
+				++rgbLines;
+			}
+		}
+	}
+	return rgbLines;
+}
+
+/// The rgb lines handled like BoblightClientConnection does with BoblightParser
+int handleParser(const QByteArray& session, std::vector<ColorRgb>& leds)
+{
+	int rgbLines = 0;
+	int begin = 0;
+	int newline;
+	while ((newline = session.indexOf('\n', begin)) >= 0)
+	{
+		BoblightParser parser(session.constData() + begin, newline - begin);
+		begin = newline + 1;
+
+		BoblightParser::Token messageParts[8];
+		const int partCount = parser.split(messageParts, 8);
+		if (partCount == 7 && messageParts[0] == "set" && messageParts[1] == "light" && messageParts[3] == "rgb")
+		{
+			unsigned ledIndex;
+			float red, green, blue;
+			if (BoblightParser::parseUInt(messageParts[2], ledIndex) && ledIndex < leds.size()
+				&& BoblightParser::parseFloat(messageParts[4], red)
+				&& BoblightParser::parseFloat(messageParts[5], green)
+				&& BoblightParser::parseFloat(messageParts[6], blue))
+			{
+				ColorRgb& rgb = leds[ledIndex];
+				rgb.red   = uint8_t(255 * qBound(0.0f, red, 1.0f));
+				rgb.green = uint8_t(255 * qBound(0.0f, green, 1.0f));
+				rgb.blue  = uint8_t(255 * qBound(0.0f, blue, 1.0f));
+				++rgbLines;
+			}
+		}
+	}
+	return rgbLines;
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	Parser parser("Replay a boblight session through the QString based and the tokenizer based message handling and compare lines/s and results");
+
+	IntOption     & argFrames = parser.add<IntOption>    ('f', "frames", "Number of generated frames [default: %1]", "600");
+	IntOption     & argLeds   = parser.add<IntOption>    ('l', "leds"  , "Number of leds [default: %1]", "300");
+	Option        & argInput  = parser.add<Option>       ('i', "input" , "Captured boblight session to replay instead of a generated one");
+	BooleanOption & argHelp   = parser.add<BooleanOption>('h', "help"  , "Show this help message and exit");
+
+	parser.process(app);
+	if (parser.isSet(argHelp))
+	{
+		parser.showHelp(0);
+	}
+
+	const int ledCount = qMax(1, argLeds.getInt(parser));
+	QByteArray session;
+	if (parser.isSet(argInput))
+	{
+		QFile file(argInput.value(parser));
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			std::cerr << "Unable to read " << file.fileName().toStdString() << std::endl;
+			return EXIT_FAILURE;
+		}
+		session = file.readAll();
+	}
+	else
+	{
+		session = createSession(ledCount, qMax(1, argFrames.getInt(parser)));
+	}
+
+	const int lines = session.count('\n');
+	std::vector<ColorRgb> legacyLeds(ledCount, ColorRgb::BLACK);
+	std::vector<ColorRgb> parserLeds(ledCount, ColorRgb::BLACK);
+
+	QElapsedTimer timer;
+	timer.start();
+	const int legacyRgb = handleLegacy(session, legacyLeds);
+	const double legacySeconds = qMax(timer.nsecsElapsed() / 1000000000.0, 0.000001);
+
+	timer.restart();
+	const int parserRgb = handleParser(session, parserLeds);
+	const double parserSeconds = qMax(timer.nsecsElapsed() / 1000000000.0, 0.000001);
+
+	std::cout << "method;lines;rgb lines;lines/s" << std::endl;
+	std::cout << std::fixed << std::setprecision(0);
+	std::cout << "qstring;" << lines << ";" << legacyRgb << ";" << lines / legacySeconds << std::endl;
+	std::cout << "tokenizer;" << lines << ";" << parserRgb << ";" << lines / parserSeconds << std::endl;
+	std::cout << std::setprecision(1) << "speedup " << legacySeconds / parserSeconds << "x" << std::endl;
+
+	if (legacyRgb != parserRgb || memcmp(legacyLeds.data(), parserLeds.data(), 3 * legacyLeds.size()) != 0)
+	{
+		std::cerr << "The tokenizer results differ from the QString results" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
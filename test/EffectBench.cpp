@@ -0,0 +1,191 @@
+// STL includes
+#include <iostream>
+#include <iomanip>
+#include <ctime>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QDir>
+
+// effect engine includes
+#include <effectengine/Effect.h>
+#include <effectengine/EffectEngine.h>
+#include <effectengine/EffectModule.h>
+#include <effectengine/EffectInterpreterPool.h>
+#include <commandline/Parser.h>
+#include <utils/Logger.h>
+
+// python utils/ global mainthread
+#include <python/PythonUtils.h>
+
+using namespace commandline;
+
+/// Start of the simulated clock, every run starts at the same time
+#define BENCH_EPOCH Q_INT64_C(1500000000000)
+
+///
+/// Effect which runs without Hyperion and with a simulated clock. Every sleep of the effect
+/// is one frame, it advances the clock immediately and hashes the output of the frame
+///
+class BenchEffect : public Effect
+{
+public:
+	BenchEffect(const EffectDefinition& definition, int ledCount, const QSize& ledGridSize, int frames)
+		: Effect(ledCount, 0, ledGridSize, 1, -1, definition.script, definition.name, definition.args)
+		, _now(BENCH_EPOCH)
+		, _frames(0)
+		, _maxFrames(frames)
+		, _outputs(0)
+		, _hash(QCryptographicHash::Md5)
+	{
+		_simulatedClock = true;
+	}
+
+	int frames() const { return _frames; }
+	int outputs() const { return _outputs; }
+	QByteArray checksum() const { return _hash.result().toHex().left(16); }
+
+protected:
+	virtual qint64 currentTime()
+	{
+		return _now;
+	}
+
+	virtual void waitFor(int ms)
+	{
+		_now += qMax(ms, 0);
+
+		// the output of the frame, stop after the last one
+		forwardOutput();
+		if (++_frames >= _maxFrames)
+		{
+			setInteruptionFlag();
+		}
+	}
+
+	virtual void writeOutput(const std::vector<ColorRgb>& ledColors, const int)
+	{
+		_hash.addData(reinterpret_cast<const char*>(ledColors.data()), int(3 * ledColors.size()));
+		++_outputs;
+	}
+
+	virtual void writeOutputImage(const Image<ColorRgb>& image, const int)
+	{
+		const int size[2] = { int(image.width()), int(image.height()) };
+		_hash.addData(reinterpret_cast<const char*>(size), sizeof(size));
+		_hash.addData(reinterpret_cast<const char*>(image.memptr()), int(3 * image.width() * image.height()));
+		++_outputs;
+	}
+
+private:
+	qint64 _now;
+	int _frames;
+	const int _maxFrames;
+	int _outputs;
+	QCryptographicHash _hash;
+};
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	Parser parser("Run effects headless with a simulated clock and report frames/s, cpu time per frame and output checksums. Positional arguments select effects by name");
+
+	IntOption     & argFrames = parser.add<IntOption>    ('f', "frames", "Number of simulated frames per effect [default: %1]", "500");
+	IntOption     & argLeds   = parser.add<IntOption>    ('l', "leds"  , "Number of leds [default: %1]", "150");
+	IntOption     & argWidth  = parser.add<IntOption>    (0x0, "width" , "Width of the led layout [default: %1]", "48");
+	IntOption     & argHeight = parser.add<IntOption>    (0x0, "height", "Height of the led layout [default: %1]", "27");
+	Option        & argPath   = parser.add<Option>       ('p', "path"  , "Additional directory with effect definitions");
+	BooleanOption & argHelp   = parser.add<BooleanOption>('h', "help"  , "Show this help message and exit");
+
+	parser.process(app);
+	if (parser.isSet(argHelp))
+	{
+		parser.showHelp(0);
+	}
+
+	const int frames = qMax(1, argFrames.getInt(parser));
+	const int ledCount = qMax(1, argLeds.getInt(parser));
+	const QSize ledGridSize(qMax(1, argWidth.getInt(parser)), qMax(1, argHeight.getInt(parser)));
+	const QStringList selected = parser.positionalArguments();
+
+	// effects log their start and errors only
+	Logger::setLogLevel(Logger::WARNING);
+	Logger* log = Logger::getInstance("EFFECTBENCH");
+
+	// the stock effects and the given directory
+	QStringList paths = QStringList() << ":/effects/";
+	if (parser.isSet(argPath))
+	{
+		paths << argPath.value(parser);
+	}
+
+	QList<EffectDefinition> definitions;
+	for (const QString& path : paths)
+	{
+		const QStringList files = QDir(path).entryList(QStringList() << "*.json", QDir::Files, QDir::Name | QDir::IgnoreCase);
+		for (const QString& file : files)
+		{
+			EffectDefinition definition;
+			if (EffectEngine::readEffectDefinition(path, file, definition, log)
+				&& (selected.isEmpty() || selected.contains(definition.name)))
+			{
+				definitions << definition;
+			}
+		}
+	}
+
+	if (definitions.isEmpty())
+	{
+		std::cerr << "No effects found" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// init python like PythonInit
+	EffectModule::registerHyperionExtensionModule();
+	Py_InitializeEx(0);
+	PyEval_InitThreads();
+	mainThreadState = PyEval_SaveThread();
+	EffectInterpreterPool::getInstance()->warmUp();
+
+	std::cout << "effect;frames;outputs;frames/s;cpu us/frame;checksum" << std::endl;
+
+	for (const EffectDefinition& definition : definitions)
+	{
+		BenchEffect effect(definition, ledCount, ledGridSize, frames);
+
+		QElapsedTimer timer;
+		timer.start();
+		const std::clock_t cpuStart = std::clock();
+
+		// run in this thread, the simulated clock never sleeps
+		effect.run();
+
+		// the last output of an effect which ended by itself
+		effect.forwardOutput();
+
+		const double cpuUs = 1000000.0 * double(std::clock() - cpuStart) / CLOCKS_PER_SEC / qMax(1, effect.frames());
+		const double fps = effect.frames() / qMax(timer.nsecsElapsed() / 1000000000.0, 0.000001);
+
+		std::cout << definition.name.toStdString() << ";"
+			<< effect.frames() << ";"
+			<< effect.outputs() << ";"
+			<< std::fixed << std::setprecision(1) << fps << ";"
+			<< std::setprecision(2) << cpuUs << ";"
+			<< effect.checksum().constData() << std::endl;
+
+		// an effect which ended before the last frame failed or stopped by itself, e.g. shutdown
+		if (effect.frames() < frames)
+		{
+			std::cerr << definition.name.toStdString() << " stopped after " << effect.frames() << " frames" << std::endl;
+		}
+	}
+
+	PyEval_RestoreThread(mainThreadState);
+	EffectInterpreterPool::getInstance()->clear();
+	Py_Finalize();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+// STL includes
+#include <iostream>
+
+// Qt includes
+#include <QTemporaryFile>
+#include <QElapsedTimer>
+
+// effect engine includes
+#include <effectengine/EffectInterpreterPool.h>
+#include <effectengine/EffectModule.h>
+
+// python utils/ global mainthread
+#include <python/PythonUtils.h>
+
+#define TEST_STARTS 20
+
+/// a script with the imports of a typical effect, fails if the globals of a previous run are still present
+const char* const TEST_SCRIPT =
+	"import hyperion, time, math, colorsys\n"
+	"assert 'value' not in globals()\n"
+	"value = sum(math.sqrt(i) for i in range(1000))\n";
+
+/// start like Effect::run did before interpreters have been pooled
+double coldStart(const QString& script)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	PyEval_RestoreThread(mainThreadState);
+	PyThreadState* tstate = Py_NewInterpreter();
+
+	QFile file(script);
+	file.open(QIODevice::ReadOnly);
+	const QByteArray code = file.readAll();
+
+	PyObject* mainDict = PyModule_GetDict(PyImport_AddModule("__main__"));
+	PyObject* result = PyRun_String(code.constData(), Py_file_input, mainDict, mainDict);
+	if (result == nullptr)
+		PyErr_Print();
+	Py_XDECREF(result);
+
+	Py_EndInterpreter(tstate);
+	PyEval_ReleaseLock();
+
+	return timer.nsecsElapsed() / 1000000.0;
+}
+
+/// start like Effect::run does with a warm interpreter and cached code
+double warmStart(const QString& script, bool& ok)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	PyEval_RestoreThread(mainThreadState);
+	PyThreadState* tstate = EffectInterpreterPool::getInstance()->acquire();
+
+	QString error;
+	PyObject* code = EffectInterpreterPool::getInstance()->getCode(script, error);
+	PyObject* mainDict = PyModule_GetDict(PyImport_AddModule("__main__"));
+	PyObject* result = (code != nullptr) ? PyEval_EvalCode(code, mainDict, mainDict) : nullptr;
+	if (result == nullptr)
+	{
+		PyErr_Print();
+		ok = false;
+	}
+	Py_XDECREF(result);
+	Py_XDECREF(code);
+
+	EffectInterpreterPool::getInstance()->release(tstate, ok);
+	PyEval_ReleaseLock();
+
+	return timer.nsecsElapsed() / 1000000.0;
+}
+
+int main()
+{
+	QTemporaryFile script("effect_XXXXXX.py");
+	if (!script.open() || script.write(TEST_SCRIPT) < 0 || !script.flush())
+	{
+		std::cerr << "Unable to write the test script" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// init python like PythonInit
+	EffectModule::registerHyperionExtensionModule();
+	Py_InitializeEx(0);
+	PyEval_InitThreads();
+	mainThreadState = PyEval_SaveThread();
+
+	double cold = 0.0;
+	for (int i = 0; i < TEST_STARTS; ++i)
+	{
+		cold += coldStart(script.fileName());
+	}
+	cold /= TEST_STARTS;
+
+	EffectInterpreterPool::getInstance()->warmUp();
+
+	bool ok = true;
+	double warm = 0.0;
+	for (int i = 0; i < TEST_STARTS && ok; ++i)
+	{
+		warm += warmStart(script.fileName(), ok);
+	}
+	warm /= TEST_STARTS;
+
+	PyEval_RestoreThread(mainThreadState);
+	EffectInterpreterPool::getInstance()->clear();
+	Py_Finalize();
+
+	std::cout << "Effect start latency: new interpreter " << cold << " ms, warm interpreter " << warm << " ms" << std::endl;
+
+	if (!ok)
+	{
+		std::cerr << "Script failed in a reused interpreter" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (warm >= cold)
+	{
+		std::cerr << "Warm start is not faster" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
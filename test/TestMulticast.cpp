@@ -0,0 +1,156 @@
+// STL includes
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QUdpSocket>
+
+// Hyperion includes
+#include <hyperion/MulticastPublisher.h>
+#include <utils/Logger.h>
+#include "udplistener/MulticastDecoder.h"
+
+/// Group and port of the test, the frames are looped back to this host
+const QHostAddress TEST_GROUP("239.255.28.250");
+const quint16 TEST_PORT = 19460;
+
+/// Frames of 1000 leds are split into the fragments 1200, 1200 and 600 bytes
+#define TEST_FRAMES 3
+#define TEST_LEDS 1000
+#define TEST_FRAGMENTS 3
+
+bool ok = true;
+
+void check(bool passed, const char* name)
+{
+	std::cout << name << ": " << (passed ? "ok" : "FAILED") << std::endl;
+	ok = ok && passed;
+}
+
+bool decode(UdpDecoderMulticast& decoder, const QByteArray& datagram)
+{
+	return decoder.decode(reinterpret_cast<const uint8_t*>(datagram.constData()), datagram.size());
+}
+
+bool equals(const std::vector<ColorRgb>& frame, const std::vector<ColorRgb>& expected)
+{
+	return frame.size() == expected.size() && memcmp(frame.data(), expected.data(), 3 * frame.size()) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+	Logger::setLogLevel(Logger::WARNING);
+
+	QUdpSocket receiver;
+	if (!receiver.bind(QHostAddress::AnyIPv4, TEST_PORT, QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint)
+		|| !receiver.joinMulticastGroup(TEST_GROUP))
+	{
+		std::cout << "Unable to join " << TEST_GROUP.toString().toStdString() << ":" << TEST_PORT << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<ColorRgb> frames[TEST_FRAMES];
+	for (int f = 0; f < TEST_FRAMES; ++f)
+	{
+		frames[f].resize(TEST_LEDS);
+		for (int led = 0; led < TEST_LEDS; ++led)
+		{
+			frames[f][led] = { uint8_t(led + f), uint8_t(led * 7 + f), uint8_t(led * 13 + f) };
+		}
+	}
+
+	MulticastPublisher publisher;
+	publisher.setTarget(QString("%1:%2").arg(TEST_GROUP.toString()).arg(TEST_PORT));
+	for (int f = 0; f < TEST_FRAMES; ++f)
+	{
+		publisher.publish(frames[f]);
+	}
+
+	// the datagrams by sequence number and fragment index
+	QByteArray datagrams[TEST_FRAMES][TEST_FRAGMENTS];
+	int received = 0;
+	QElapsedTimer timer;
+	timer.start();
+	while (received < TEST_FRAMES * TEST_FRAGMENTS && timer.elapsed() < 1000)
+	{
+		if (!receiver.hasPendingDatagrams() && !receiver.waitForReadyRead(100))
+			continue;
+
+		QByteArray datagram(int(receiver.pendingDatagramSize()), 0);
+		receiver.readDatagram(datagram.data(), datagram.size());
+		if (datagram.size() < MULTICAST_HEADER_SIZE)
+			continue;
+
+		const uint8_t* header = reinterpret_cast<const uint8_t*>(datagram.constData());
+		const quint32 sequence = (quint32(header[8]) << 24) | (quint32(header[9]) << 16) | (quint32(header[10]) << 8) | header[11];
+		const quint32 index = (quint32(header[12]) << 8) | header[13];
+		if (sequence < TEST_FRAMES && index < TEST_FRAGMENTS && datagrams[sequence][index].isEmpty())
+		{
+			datagrams[sequence][index] = datagram;
+			++received;
+		}
+	}
+	check(received == TEST_FRAMES * TEST_FRAGMENTS, "loopback receives all fragments");
+	if (!ok)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// in order
+	UdpDecoderMulticast ordered;
+	int completed = 0;
+	for (int f = 0; f < TEST_FRAMES; ++f)
+	{
+		for (int i = 0; i < TEST_FRAGMENTS; ++i)
+		{
+			if (decode(ordered, datagrams[f][i]))
+			{
+				completed += equals(ordered.getFrame(), frames[f]) ? 1 : 0;
+			}
+		}
+	}
+	check(completed == TEST_FRAMES && ordered.getLostFrames() == 0, "reassembly in order");
+
+	// reordered fragments
+	UdpDecoderMulticast decoder;
+	bool passed = !decode(decoder, datagrams[0][2]) && !decode(decoder, datagrams[0][0]) && decode(decoder, datagrams[0][1]);
+	check(passed && equals(decoder.getFrame(), frames[0]), "reassembly of reordered fragments");
+
+	// the second frame lost a fragment, the third one drops it
+	passed = !decode(decoder, datagrams[1][0]) && !decode(decoder, datagrams[2][0]) && !decode(decoder, datagrams[2][1]);
+	check(passed, "newer frame drops the incomplete one");
+
+	// fragments of the dropped frame arrive late
+	passed = !decode(decoder, datagrams[1][1]) && !decode(decoder, datagrams[1][2]);
+	check(passed, "late fragments are ignored");
+
+	passed = decode(decoder, datagrams[2][2]);
+	check(passed && equals(decoder.getFrame(), frames[2]), "reassembly after loss");
+	check(decoder.getCompletedFrames() == 2 && decoder.getLostFrames() == 1, "lost frames accounted");
+
+	// duplicates and outdated frames
+	passed = !decode(decoder, datagrams[2][0]) && !decode(decoder, datagrams[0][0]) && !decode(decoder, datagrams[0][1]) && !decode(decoder, datagrams[0][2]);
+	check(passed && equals(decoder.getFrame(), frames[2]), "duplicate and outdated fragments are ignored");
+
+	// truncated fragment
+	passed = !decode(decoder, datagrams[2][1].left(MULTICAST_HEADER_SIZE + 100));
+	check(passed, "truncated fragments are ignored");
+
+	// the publisher restarted, its sequence starts at 0 again within a new session
+	QByteArray restarted[TEST_FRAGMENTS];
+	for (int i = 0; i < TEST_FRAGMENTS; ++i)
+	{
+		restarted[i] = datagrams[0][i];
+		restarted[i][4] = char(~restarted[i][4]);
+	}
+	passed = !decode(decoder, restarted[0]) && !decode(decoder, restarted[1]) && decode(decoder, restarted[2]);
+	check(passed && equals(decoder.getFrame(), frames[0]), "restarted publisher is accepted immediately");
+	check(decoder.getCompletedFrames() == 3 && decoder.getLostFrames() == 1, "restart is not accounted as loss");
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
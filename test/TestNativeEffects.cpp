@@ -0,0 +1,138 @@
+// STL includes
+#include <iostream>
+#include <ctime>
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QFile>
+
+// effect engine includes
+#include <effectengine/NativeEffect.h>
+
+const int BENCH_FRAMES = 2000;
+const int BENCH_LEDS = 150;
+
+bool ok = true;
+
+void check(bool passed, const QString& name)
+{
+	std::cout << name.toStdString() << ": " << (passed ? "ok" : "FAILED") << std::endl;
+	ok = ok && passed;
+}
+
+/// knight rider in red: a 25 pixel strip with the head at full red, the tail fades in red only
+bool checkKnightRider(const NativeEffect* effect)
+{
+	const QImage& image = effect->image();
+	if (!effect->hasImageOutput() || image.size() != QSize(25, 1))
+		return false;
+
+	bool head = false;
+	for (int x = 0; x < image.width(); ++x)
+	{
+		const QRgb pixel = image.pixel(x, 0);
+		head = head || qRed(pixel) == 255;
+		if (qGreen(pixel) != 0 || qBlue(pixel) != 0)
+			return false;
+	}
+	return head;
+}
+
+/// blue mood blobs: one color per led, the hue stays within 60 degrees around blue
+bool checkMoodBlobs(const NativeEffect* effect)
+{
+	const QVector<ColorRgb>& colors = effect->colors();
+	if (effect->hasImageOutput() || colors.size() != BENCH_LEDS)
+		return false;
+
+	bool lit = false;
+	for (const ColorRgb& color : colors)
+	{
+		lit = lit || color.blue > 0;
+		if (color.blue < color.red || color.blue < color.green)
+			return false;
+	}
+	return lit;
+}
+
+/// rainbow swirl: an image of at least 64x64 which shows red, green and blue areas
+bool checkSwirl(const NativeEffect* effect)
+{
+	const QImage& image = effect->image();
+	if (!effect->hasImageOutput() || image.width() < 64 || image.height() < 64)
+		return false;
+
+	bool red = false, green = false, blue = false;
+	for (int y = 0; y < image.height(); ++y)
+	{
+		for (int x = 0; x < image.width(); ++x)
+		{
+			const QRgb pixel = image.pixel(x, y);
+			red   = red   || (qRed(pixel)   > 200 && qGreen(pixel) < 100 && qBlue(pixel)  < 100);
+			green = green || (qGreen(pixel) > 200 && qRed(pixel)   < 100 && qBlue(pixel)  < 100);
+			blue  = blue  || (qBlue(pixel)  > 200 && qRed(pixel)   < 100 && qGreen(pixel) < 100);
+		}
+	}
+	return red && green && blue;
+}
+
+int main(int argc, char** argv)
+{
+	// the directory of the stock effect definitions
+	const QString effectPath = (argc > 1) ? argv[1] : "effects";
+
+	const struct { const char* file; bool (*check)(const NativeEffect*); } definitions[] = {
+		{ "native-rainbow-swirl.json",   checkSwirl },
+		{ "native-knight-rider.json",    checkKnightRider },
+		{ "native-mood-blobs-blue.json", checkMoodBlobs }
+	};
+
+	for (const auto& entry : definitions)
+	{
+		const QString file = entry.file;
+		QFile definitionFile(effectPath + "/" + file);
+		if (!definitionFile.open(QIODevice::ReadOnly))
+		{
+			std::cerr << "Unable to read " << file.toStdString() << ", pass the effects directory as argument" << std::endl;
+			return EXIT_FAILURE;
+		}
+		const QJsonObject definition = QJsonDocument::fromJson(definitionFile.readAll()).object();
+		const QString script = definition["script"].toString();
+
+		NativeEffect* effect = NativeEffect::create(script);
+		if (effect == nullptr)
+		{
+			std::cerr << "Native effect " << script.toStdString() << " not available" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// a typical layout of a tv, 16:9 led grid
+		effect->setup(definition["args"].toObject(), BENCH_LEDS, 0, QSize(48, 27));
+
+		const QString name = definition["name"].toString();
+		check(effect->render() > 0, name + " schedules the next frame");
+		check(entry.check(effect), name + " renders the expected output");
+
+		QElapsedTimer timer;
+		timer.start();
+		const std::clock_t cpuStart = std::clock();
+
+		for (int frame = 0; frame < BENCH_FRAMES; ++frame)
+		{
+			effect->render();
+		}
+
+		const double cpuUs = 1000000.0 * double(std::clock() - cpuStart) / CLOCKS_PER_SEC / BENCH_FRAMES;
+		const double wallUs = timer.nsecsElapsed() / 1000.0 / BENCH_FRAMES;
+
+		std::cout << name.toStdString()
+			<< ": " << cpuUs << " us cpu per frame, " << wallUs << " us per frame"
+			<< (effect->hasImageOutput() ? " (image " : " (leds ")
+			<< effect->image().width() << "x" << effect->image().height() << ")" << std::endl;
+
+		delete effect;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
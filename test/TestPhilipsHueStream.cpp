@@ -0,0 +1,145 @@
+// STL includes
+#include <iostream>
+#include <vector>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QUdpSocket>
+#include <QElapsedTimer>
+#include <QTimer>
+
+// Leddevice includes
+#include "leddevice/dev_net/LedDevicePhilipsHue.h"
+
+#define TEST_INTERVAL 20
+#define TEST_FRAMES 100
+#define TEST_FRAME_INTERVAL 2
+
+/// Stand-in for the entertainment port of a bridge, records the received messages and their arrival times
+class StreamReceiver : public QObject
+{
+public:
+	StreamReceiver()
+	{
+		_socket.bind(QHostAddress::LocalHost, 0);
+		connect(&_socket, &QUdpSocket::readyRead, this, &StreamReceiver::readPendingDatagrams);
+		_timer.start();
+	}
+
+	quint16 port() const { return _socket.localPort(); }
+
+	std::vector<QByteArray> messages;
+	std::vector<qint64> arrivals;
+
+private:
+	void readPendingDatagrams()
+	{
+		while (_socket.hasPendingDatagrams())
+		{
+			QByteArray datagram(_socket.pendingDatagramSize(), 0);
+			_socket.readDatagram(datagram.data(), datagram.size());
+			messages.push_back(datagram);
+			arrivals.push_back(_timer.elapsed());
+		}
+	}
+
+	QUdpSocket _socket;
+	QElapsedTimer _timer;
+};
+
+bool verifyMessage(const QByteArray& message, const std::vector<unsigned int>& lightIds, const ColorRgb& color)
+{
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(message.constData());
+
+	if (message.size() != int(16 + 9 * lightIds.size()) || memcmp(data, "HueStream", 9) != 0 || data[9] != 0x01 || data[10] != 0x00 || data[14] != 0x00)
+	{
+		std::cerr << "Invalid header" << std::endl;
+		return false;
+	}
+
+	for (size_t idx = 0; idx < lightIds.size(); ++idx)
+	{
+		const uint8_t* light = data + 16 + 9 * idx;
+		if (light[0] != 0x00 || ((light[1] << 8) | light[2]) != int(lightIds[idx])
+			|| ((light[3] << 8) | light[4]) != color.red * 257
+			|| ((light[5] << 8) | light[6]) != color.green * 257
+			|| ((light[7] << 8) | light[8]) != color.blue * 257)
+		{
+			std::cerr << "Invalid light " << idx << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+	Logger* log = Logger::getInstance("TEST");
+
+	StreamReceiver receiver;
+
+	// an empty clientkey streams unencrypted
+	PhilipsHueStream stream(log, "127.0.0.1", receiver.port(), "user", "", TEST_INTERVAL);
+	stream.open();
+	if (!stream.isOpen())
+	{
+		std::cerr << "Stream not open" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<unsigned int> lightIds = { 3, 7, 258 };
+	int frame = 0;
+
+	// frames arrive ten times faster than the stream interval
+	QTimer frameTimer;
+	QObject::connect(&frameTimer, &QTimer::timeout, [&]()
+	{
+		const uint8_t value = uint8_t(frame);
+		stream.setColors(lightIds, std::vector<ColorRgb>(lightIds.size(), ColorRgb{value, uint8_t(255 - value), 128}));
+		if (++frame == TEST_FRAMES)
+		{
+			frameTimer.stop();
+			QTimer::singleShot(5 * TEST_INTERVAL, &app, &QCoreApplication::quit);
+		}
+	});
+	frameTimer.start(TEST_FRAME_INTERVAL);
+
+	app.exec();
+
+	const size_t count = receiver.messages.size();
+	std::cout << "Frames: " << TEST_FRAMES << ", messages: " << count << std::endl;
+
+	if (count == 0 || count >= TEST_FRAMES)
+	{
+		std::cerr << "Frames have not been merged" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// the newest frame has to be sent last
+	const uint8_t last = uint8_t(TEST_FRAMES - 1);
+	if (!verifyMessage(receiver.messages.back(), lightIds, ColorRgb{last, uint8_t(255 - last), 128}))
+	{
+		return EXIT_FAILURE;
+	}
+
+	for (size_t idx = 1; idx < count; ++idx)
+	{
+		// allow 2ms for timer granularity
+		const qint64 interval = receiver.arrivals[idx] - receiver.arrivals[idx - 1];
+		if (interval < TEST_INTERVAL - 2)
+		{
+			std::cerr << "Message " << idx << " sent after " << interval << "ms" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (uint8_t(receiver.messages[idx][11]) != uint8_t(receiver.messages[idx - 1][11] + 1))
+		{
+			std::cerr << "Message " << idx << " has an invalid sequence number" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::cout << "HueStream test passed" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+// STL includes
+#include <iostream>
+#include <cstdlib>
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+
+// Hyperion includes
+#include <hyperion/PriorityMuxer.h>
+#include <utils/Logger.h>
+
+/// The deadlines are wall clock ms, the expiry may be measured this much early in ms
+const qint64 CLOCK_GRANULARITY = 1;
+
+/// Maximum delay of an expiry in ms, the muxer used to poll every 250ms
+const qint64 MAX_DELAY = 100;
+
+/// The priorities and their timeouts in ms, the last one is endless and must stay
+const int TEST_PRIORITIES[] = { 50, 60, 70, 80 };
+const int TEST_TIMEOUTS[]   = { 100, 30, 250, -1 };
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+	Logger::setLogLevel(Logger::WARNING);
+
+	PriorityMuxer muxer(10);
+	const std::vector<ColorRgb> ledColors(10, ColorRgb::RED);
+	QElapsedTimer timer;
+	qint64 measured[4] = { -1, -1, -1, -1 };
+
+	QObject::connect(&muxer, &PriorityMuxer::priorityChanged, [&](const quint8& priority, const bool& enabled)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			if (!enabled && priority == TEST_PRIORITIES[i])
+			{
+				measured[i] = timer.elapsed();
+			}
+		}
+	});
+
+	timer.start();
+	for (int i = 0; i < 4; ++i)
+	{
+		muxer.registerInput(TEST_PRIORITIES[i], hyperion::COMP_COLOR, "Test");
+		muxer.setInput(TEST_PRIORITIES[i], ledColors, TEST_TIMEOUTS[i]);
+	}
+
+	// a refresh restarts the timeout, the queued one is outdated
+	muxer.setInput(TEST_PRIORITIES[0], ledColors, TEST_TIMEOUTS[0]);
+
+	QTimer::singleShot(500, &app, &QCoreApplication::quit);
+	app.exec();
+
+	bool ok = true;
+	for (int i = 0; i < 4; ++i)
+	{
+		const bool passed = (TEST_TIMEOUTS[i] < 0) ? measured[i] == -1 : measured[i] >= TEST_TIMEOUTS[i] - CLOCK_GRANULARITY && measured[i] <= TEST_TIMEOUTS[i] + MAX_DELAY;
+		std::cout << "priority " << TEST_PRIORITIES[i] << ": timeout " << TEST_TIMEOUTS[i] << "ms, cleared after " << measured[i] << "ms " << (passed ? "ok" : "FAILED") << std::endl;
+		ok = ok && passed;
+	}
+
+	if (muxer.getCurrentPriority() != TEST_PRIORITIES[3])
+	{
+		std::cout << "visible priority " << muxer.getCurrentPriority() << ", expected " << TEST_PRIORITIES[3] << std::endl;
+		ok = false;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}